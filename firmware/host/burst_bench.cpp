@@ -0,0 +1,195 @@
+/**
+ * @file burst_bench.cpp
+ * @brief Host measurement of the airtime saved by the burst mode of the next modem
+ * 	- single: every packet gets its own synchronization and metadata symbol
+ * 	- burst: Encoder::burst(), one synchronization and metadata symbol for up to Encoder::getBurstMax() packets
+ * 	- Messages of 1 KB to 10 KB, the airtime is the length of the encoded audio
+ * 	- Both are resampled as if the receiver clock ran PPM parts per million fast, with white noise at SNR dB,
+ * 	  decoded and the message reassembled from the payloads.  Every message must come through in burst mode.
+ * @note usage: burst_bench [-m MODE] [-p PPM] [-s SNR]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <vector>
+#include "encode.hh"
+#include "decode.hh"
+
+typedef float value;
+typedef DSP::Complex<value> cmplx;
+
+static const int sample_rate = 8000;
+static const int freq_off = 1600;
+static const int block_len = 1440;
+
+static std::vector<int16_t> *sink_audio;
+
+static void sampleSink(int16_t samples[], int count)
+{
+	sink_audio->insert(sink_audio->end(), samples, samples + count);
+}
+
+//! Discards the diagnostic output of the encoder and decoder
+struct Quiet
+{
+	struct NullBuffer : std::streambuf
+	{
+		int overflow(int c) override
+		{
+			return c;
+		}
+	} null_buffer;
+	std::streambuf *err;
+	Quiet() : err(std::cerr.rdbuf(&null_buffer))
+	{
+	}
+	~Quiet()
+	{
+		std::cerr.rdbuf(err);
+	}
+};
+
+static std::vector<int16_t> encode(const modem_config_t *config, const std::vector<uint8_t> &message, bool burst)
+{
+	auto *encoder = new Encoder<value, cmplx, sample_rate>();
+	std::vector<int16_t> audio;
+	sink_audio = &audio;
+	encoder->setSampleSink(sampleSink);
+	encoder->configure(freq_off, config);
+	uint64_t call_sign = 1;
+	if (burst) {
+		encoder->burst(call_sign, message.data(), message.size());
+	} else {
+		int size = encoder->getPacketSize();
+		for (size_t i = 0; i < message.size(); i += size) {
+			encoder->synchronization_symbol();
+			encoder->metadata_symbol(call_sign);
+			encoder->data_packet(message.data() + i, std::min<int>(size, message.size() - i));
+		}
+	}
+	// End of the transmission, flushes the last payload symbol through the decoder
+	encoder->silence_packet();
+	sink_audio = nullptr;
+	delete encoder;
+	return audio;
+}
+
+//! Band limited resampling, output sample n is taken at the input time n / (1 + ppm / 1e6), plus white noise
+static std::vector<int16_t> channel(const std::vector<int16_t> &input, double ppm, double snr)
+{
+	const int taps = 32;
+	const double pi = 3.14159265358979323846;
+	double power = 0;
+	for (int16_t x : input)
+		power += double(x) * x;
+	std::mt19937 rng(1);
+	std::normal_distribution<double> awgn(0, std::sqrt(power / input.size() / std::pow(10, snr / 10)));
+	double step = 1 / (1 + ppm * 1e-6);
+	std::vector<int16_t> output;
+	for (double t = 0; t < input.size(); t += step) {
+		int n = std::floor(t);
+		double sum = awgn(rng);
+		for (int k = n - taps / 2 + 1; k <= n + taps / 2; ++k) {
+			if (k < 0 || k >= int(input.size()))
+				continue;
+			double x = t - k;
+			double sinc = x == 0 ? 1 : std::sin(pi * x) / (pi * x);
+			double window = 0.5 + 0.5 * std::cos(pi * x / (taps / 2));
+			sum += input[k] * sinc * window;
+		}
+		output.push_back(std::min<double>(std::max<double>(std::nearbyint(sum), -32768), 32767));
+	}
+	return output;
+}
+
+//! Reassembles the message from the payloads in the order of their arrival, returns the number of payloads
+static int decode(const std::vector<int16_t> &audio, std::vector<uint8_t> &message, int packet_size)
+{
+	auto *decoder = new Decoder<value, cmplx, sample_rate>();
+	uint8_t payload[1024];
+	int count = 0;
+	std::vector<int16_t> block(block_len);
+	for (size_t i = 0; i < audio.size() + 4 * block_len; i += block_len) {
+		for (int j = 0; j < block_len; ++j)
+			block[j] = i + j < audio.size() ? audio[i + j] : 0;
+		if (!decoder->feed(block.data(), block_len) || decoder->process() != STATUS_DONE)
+			continue;
+		int len = decoder->fetch(payload);
+		if (len > 0) {
+			message.insert(message.end(), payload, payload + std::min(len, packet_size));
+			++count;
+		}
+	}
+	delete decoder;
+	return count;
+}
+
+int main(int argc, char **argv)
+{
+	std::vector<int> modes = { 20, 23, 25, 29 };
+	double ppm = 100;
+	double snr = 20;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "-m") && i + 1 < argc)
+			modes = { std::atoi(argv[++i]) };
+		else if (!std::strcmp(argv[i], "-p") && i + 1 < argc)
+			ppm = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "-s") && i + 1 < argc)
+			snr = std::atof(argv[++i]);
+		else {
+			std::cerr << "usage: " << argv[0] << " [-m MODE] [-p PPM] [-s SNR]" << std::endl;
+			return 1;
+		}
+	}
+	std::cout << "clock offset " << ppm << " ppm, SNR " << snr << " dB" << std::endl << std::fixed;
+	std::cout << "mode  message packets   single: airtime decoded   burst: airtime decoded   saved" << std::endl;
+	bool ok = true;
+	std::mt19937 rng(42);
+	for (int mode : modes) {
+		const modem_config_t *config = nullptr;
+		for (auto &c : modem_configs)
+			if (c.oper_mode == mode && c.code_order)
+				config = &c;
+		if (!config) {
+			std::cerr << "unknown mode " << mode << std::endl;
+			return 1;
+		}
+		// Same as Encoder::getPacketSize()
+		int packet_size = (1 << (config->code_order - 4)) - 1;
+		for (int kb : { 1, 2, 5, 10 }) {
+			std::vector<uint8_t> message(kb * 1024);
+			for (auto &b : message)
+				b = rng();
+			int packets = (message.size() + packet_size - 1) / packet_size;
+			std::vector<uint8_t> single_rx, burst_rx;
+			std::vector<int16_t> single_tx, burst_tx;
+			int single_count, burst_count;
+			{
+				Quiet quiet;
+				single_tx = encode(config, message, false);
+				burst_tx = encode(config, message, true);
+				single_count = decode(channel(single_tx, ppm, snr), single_rx, packet_size);
+				burst_count = decode(channel(burst_tx, ppm, snr), burst_rx, packet_size);
+			}
+			single_rx.resize(std::min(single_rx.size(), message.size()));
+			burst_rx.resize(std::min(burst_rx.size(), message.size()));
+			bool single_ok = single_rx == message, burst_ok = burst_rx == message;
+			double single_time = double(single_tx.size()) / sample_rate;
+			double burst_time = double(burst_tx.size()) / sample_rate;
+			std::cout << std::setw(4) << mode << std::setw(6) << kb << " KB" << std::setw(8) << packets
+				<< std::setw(16) << std::setprecision(1) << single_time << " s" << std::setw(5) << single_count << (single_ok ? " ok" : "   ")
+				<< std::setw(15) << burst_time << " s" << std::setw(5) << burst_count << (burst_ok ? " ok" : "   ")
+				<< std::setw(7) << std::setprecision(0) << 100 * (1 - burst_time / single_time) << " %" << std::endl;
+			ok &= burst_ok;
+		}
+	}
+	return !ok;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file crc_bench.cpp
+ * @brief Host check and benchmark of the CRC32 check of the list candidates of the next decoder
+ * 	- bitwise: CODE::CRC, one bit and one lane at a time, as the decoders did before
+ * 	- list: CODE::ListCRC, the first lane word by word, then all the others side by side
+ * 	- Random candidates of the sizes of codes of order 10 to 14, with the valid CRC in the first lane,
+ * 	  in the last lane or in none.  Both must pick the same lane.
+ * @note usage: crc_bench [-n REPEATS]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "simd.hh"
+#include "crc.hh"
+#include "list_crc.hh"
+
+typedef int8_t code_type;
+
+static const uint32_t poly = 0x8F6E37A0;
+
+template <typename TYPE>
+static int bitwise(CODE::CRC<uint32_t> &crc, const TYPE *mesg, int bits)
+{
+	for (int k = 0; k < TYPE::SIZE; ++k) {
+		crc.reset();
+		for (int i = 0; i < bits; ++i)
+			crc(mesg[i].v[k] < 0);
+		if (crc() == 0)
+			return k;
+	}
+	return -1;
+}
+
+template <int SIZE>
+static bool bench(int code_order, int pass, int repeats)
+{
+	typedef SIMD<code_type, SIZE> mesg_type;
+	static CODE::CRC<uint32_t> crc(poly);
+	static CODE::ListCRC<uint32_t> list_crc(poly);
+	int bits = (1 << (code_order - 1)) + 32;
+	std::mt19937 rng(code_order * 64 + SIZE);
+	std::vector<mesg_type> mesg(bits);
+	for (auto &m : mesg)
+		for (int k = 0; k < SIZE; ++k)
+			m.v[k] = rng();
+	if (pass >= 0) {
+		crc.reset();
+		for (int i = 0; i < bits - 32; ++i)
+			crc(mesg[i].v[pass] < 0);
+		uint32_t sum = crc();
+		for (int i = 0; i < 32; ++i)
+			mesg[bits - 32 + i].v[pass] = (sum >> i) & 1 ? -1 : 1;
+	}
+	int old_lane = 0, new_lane = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeats; ++r)
+		old_lane = bitwise(crc, mesg.data(), bits);
+	std::chrono::duration<double> old_time = std::chrono::steady_clock::now() - start;
+	start = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeats; ++r)
+		new_lane = list_crc(mesg.data(), bits);
+	std::chrono::duration<double> new_time = std::chrono::steady_clock::now() - start;
+	std::cout << "order " << code_order << ", list " << std::setw(2) << SIZE << ", passing lane " << std::setw(2) << pass
+		<< ": bitwise " << std::setw(8) << std::setprecision(2) << old_time.count() * 1e6 / repeats
+		<< " us, list " << std::setw(7) << new_time.count() * 1e6 / repeats << " us, "
+		<< std::setw(5) << std::setprecision(1) << old_time.count() / new_time.count() << " x";
+	bool ok = old_lane == pass && new_lane == pass;
+	if (!ok)
+		std::cout << ", lanes " << old_lane << " and " << new_lane;
+	std::cout << std::endl;
+	return ok;
+}
+
+template <int SIZE>
+static bool bench(int repeats)
+{
+	bool ok = true;
+	for (int code_order = 10; code_order <= 14; ++code_order) {
+		ok &= bench<SIZE>(code_order, 0, repeats);
+		if (SIZE > 1)
+			ok &= bench<SIZE>(code_order, SIZE - 1, repeats);
+		ok &= bench<SIZE>(code_order, -1, repeats);
+	}
+	return ok;
+}
+
+int main(int argc, char **argv)
+{
+	int repeats = 100;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+			repeats = std::atoi(argv[++i]);
+		else {
+			std::cerr << "usage: " << argv[0] << " [-n REPEATS]" << std::endl;
+			return 1;
+		}
+	}
+	std::cout << std::fixed;
+	bool ok = bench<1>(repeats);
+	ok &= bench<4>(repeats);
+	ok &= bench<16>(repeats);
+	ok &= bench<32>(repeats);
+	std::cout << (ok ? "same lanes" : "MISMATCH") << std::endl;
+	return !ok;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file decimator_bench.cpp
+ * @brief Host accuracy check and benchmark of the 48 kHz to 8 kHz decimator in front of the next decoder
+ * 	- Reference: the 48 kHz recording decoded by Decoder<..., 48000>
+ * 	- Decimated: the same recording fed to Decoder<..., 8000, ..., 48000>, its Synchronizer decimates
+ * 	  with DSP::Decimator<..., 6, TAPS>
+ * 	- Pipeline: the same recording through the front end of RxPipeline<..., 48000>, that decimates
+ * 	  before it queues the blocks, and its back end at 8 kHz
+ * 	- All payloads must be identical.  Reports the decoding times, the passband ripple of the filter
+ * 	  over the band of the modem and its attenuation of the bands, that alias onto it.
+ * @note usage: decimator_bench [WAV]
+ * 	The default WAV is aicodix-modem-master/data/encoded.wav, a mode 29 packet sampled at 48 kHz.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <streambuf>
+#include <vector>
+#include "decimator.hh"
+#include "rx_pipeline.hh"
+
+typedef float value;
+typedef DSP::Complex<value> cmplx;
+
+typedef Decoder<value, cmplx, 8000, DefaultSlopeEstimator, 48000> decimating_type;
+typedef RxPipeline<value, cmplx, 8000, 16, DefaultSlopeEstimator, 48000> pipeline_type;
+typedef Synchronizer<value, cmplx, 8000, 48000>::decimator_type decimator_type;
+static const int factor = decimator_type::factor();
+static const int taps = decimator_type::taps();
+
+// Band of the modems around 1600 Hz, mode 29 and 30 occupy 1900 Hz
+static const value band_low = 600, band_high = 2600;
+
+//! Discards the diagnostic output of the decoder
+struct Quiet
+{
+	struct NullBuffer : std::streambuf
+	{
+		int overflow(int c) override
+		{
+			return c;
+		}
+	} null_buffer;
+	std::streambuf *err;
+	Quiet() : err(std::cerr.rdbuf(&null_buffer))
+	{
+	}
+	~Quiet()
+	{
+		std::cerr.rdbuf(err);
+	}
+};
+
+struct Result
+{
+	std::vector<uint8_t> payload;
+	double seconds = 0;
+};
+
+//! Feeds whole blocks, followed by silence to flush the decoder
+template <typename DECODER>
+static Result decode(const std::vector<int16_t> &audio)
+{
+	auto *decoder = new DECODER();
+	int feed_len = decoder->getInputLen();
+	Result result;
+	uint8_t payload[1024];
+	std::vector<int16_t> block(feed_len);
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < audio.size() + 16 * feed_len && result.payload.empty(); i += feed_len) {
+		for (int j = 0; j < feed_len; ++j)
+			block[j] = i + j < audio.size() ? audio[i + j] : 0;
+		if (!decoder->feed(block.data(), feed_len) || decoder->process() != STATUS_DONE)
+			continue;
+		int len = decoder->fetch(payload);
+		if (len > 0)
+			result.payload.assign(payload, payload + len);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	result.seconds = elapsed.count();
+	delete decoder;
+	return result;
+}
+
+//! Same with both stages of the pipeline in turn on one thread
+static Result pipeline(const std::vector<int16_t> &audio)
+{
+	auto *pipeline = new pipeline_type();
+	int feed_len = pipeline->getInputLen();
+	Result result;
+	uint8_t payload[1024];
+	std::vector<int16_t> block(feed_len);
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < audio.size() + 16 * feed_len && result.payload.empty(); i += feed_len) {
+		for (int j = 0; j < feed_len; ++j)
+			block[j] = i + j < audio.size() ? audio[i + j] : 0;
+		pipeline->frontend(block.data(), feed_len);
+		if (pipeline->backend() != STATUS_DONE)
+			continue;
+		int len = pipeline->getDecoder().fetch(payload);
+		if (len > 0)
+			result.payload.assign(payload, payload + len);
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	result.seconds = elapsed.count();
+	delete pipeline;
+	return result;
+}
+
+//! Gain of the filter in dB at the given frequency
+static value response(const value *coef, value freq, value rate)
+{
+	value re = 0, im = 0;
+	for (int i = 0; i < taps; ++i) {
+		re += coef[i] * std::cos(2 * DSP::Const<value>::Pi() * freq * i / rate);
+		im -= coef[i] * std::sin(2 * DSP::Const<value>::Pi() * freq * i / rate);
+	}
+	return 10 * std::log10(re * re + im * im);
+}
+
+int main(int argc, char **argv)
+{
+	const char *name = argc > 1 ? argv[1] : DEFAULT_WAV;
+	DSP::ReadWAV<value> wav(name);
+	if (wav.rate() != factor * 8000 || wav.channels() != 1) {
+		std::cerr << "need a mono WAV file at " << factor * 8000 << " Hz: " << name << std::endl;
+		return 1;
+	}
+	std::vector<value> samples(wav.frames());
+	wav.read(samples.data(), samples.size());
+	std::vector<int16_t> audio(samples.size());
+	for (size_t i = 0; i < samples.size(); ++i)
+		audio[i] = std::nearbyint(32767 * samples[i]);
+	std::cout << name << ": " << audio.size() << " samples at " << wav.rate() << " Hz" << std::endl;
+
+	static decimator_type decimator;
+	Result reference, decimated, pipelined;
+	{
+		Quiet quiet;
+		reference = decode<Decoder<value, cmplx, 48000>>(audio);
+		decimated = decode<decimating_type>(audio);
+		pipelined = pipeline(audio);
+	}
+	value ripple = 0, alias = 0;
+	for (value f = band_low; f <= band_high; f += 10)
+		ripple = std::max(ripple, std::abs(response(decimator.coefficients(), f, 48000)));
+	alias = -1000;
+	for (int k = 1; k <= factor / 2; ++k) {
+		for (value f = band_low; f <= band_high; f += 10) {
+			for (value image : { k * value(8000) - f, k * value(8000) + f })
+				if (image < 24000)
+					alias = std::max(alias, response(decimator.coefficients(), image, 48000));
+		}
+	}
+	std::cout << "decimator: " << taps << " taps, passband ripple " << std::setprecision(3) << ripple
+		<< " dB, alias attenuation " << std::fixed << std::setprecision(1) << -alias << " dB over "
+		<< int(band_low) << " .. " << int(band_high) << " Hz" << std::endl;
+	std::cout << "48 kHz decoder:      " << reference.payload.size() << " bytes in " << std::setprecision(1)
+		<< reference.seconds * 1e3 << " ms" << std::endl;
+	std::cout << "decimated 8 kHz:     " << decimated.payload.size() << " bytes in " << std::setprecision(1)
+		<< decimated.seconds * 1e3 << " ms" << std::endl;
+	std::cout << "pipeline 8 kHz:      " << pipelined.payload.size() << " bytes in " << std::setprecision(1)
+		<< pipelined.seconds * 1e3 << " ms" << std::endl;
+	bool same = !reference.payload.empty() && reference.payload == decimated.payload && reference.payload == pipelined.payload;
+	std::cout << "payloads: " << (same ? "same" : "DIFFERENT") << std::endl;
+	return !same;
+}
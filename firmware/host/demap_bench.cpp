@@ -0,0 +1,128 @@
+/**
+ * @file demap_bench.cpp
+ * @brief Host check and benchmark of the row-wise soft demapper of the next decoder
+ * 	- point: soft() of the modulation, one constellation point at a time, behind a switch on the bits per point,
+ * 	  as the decoder did before
+ * 	- row: SoftDemapper::row(), one call per row of constellation points
+ * 	- Noisy points of QPSK, 8PSK, QAM16 and QAM64 at the precisions seen by the decoder, plus points that
+ * 	  quantize to exactly half way between two integers and far outside the int8_t range.
+ * 	  The soft bits of both must be identical.
+ * @note usage: demap_bench [-n POINTS]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "complex.hh"
+#include "demapper.hh"
+
+typedef float value;
+typedef DSP::Complex<value> cmplx;
+typedef int8_t code_type;
+typedef SoftDemapper<cmplx, code_type> demapper_type;
+
+// One row of the widest mode
+static const int row_len = 256;
+
+static void point_soft(int bits, code_type *b, cmplx c, value precision)
+{
+	switch (bits) {
+	case 2:
+		return PhaseShiftKeying<4, cmplx, code_type>::soft(b, c, precision);
+	case 3:
+		return PhaseShiftKeying<8, cmplx, code_type>::soft(b, c, precision);
+	case 4:
+		return QuadratureAmplitudeModulation<16, cmplx, code_type>::soft(b, c, precision);
+	case 6:
+		return QuadratureAmplitudeModulation<64, cmplx, code_type>::soft(b, c, precision);
+	}
+}
+
+static cmplx point_map(int bits, code_type *b)
+{
+	switch (bits) {
+	case 2:
+		return PhaseShiftKeying<4, cmplx, code_type>::map(b);
+	case 3:
+		return PhaseShiftKeying<8, cmplx, code_type>::map(b);
+	case 4:
+		return QuadratureAmplitudeModulation<16, cmplx, code_type>::map(b);
+	case 6:
+		return QuadratureAmplitudeModulation<64, cmplx, code_type>::map(b);
+	}
+	return 0;
+}
+
+static value dist(int bits)
+{
+	switch (bits) {
+	case 2:
+		return PhaseShiftKeying<4, cmplx, code_type>::DIST;
+	case 3:
+		return PhaseShiftKeying<8, cmplx, code_type>::DIST;
+	case 4:
+		return QuadratureAmplitudeModulation<16, cmplx, code_type>::DIST;
+	}
+	return QuadratureAmplitudeModulation<64, cmplx, code_type>::DIST;
+}
+
+int main(int argc, char **argv)
+{
+	int count = 1 << 20;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+			count = std::atoi(argv[++i]);
+		else {
+			std::cerr << "usage: " << argv[0] << " [-n POINTS]" << std::endl;
+			return 1;
+		}
+	}
+	count = (count + row_len - 1) / row_len * row_len;
+	std::mt19937 rng(42);
+	std::normal_distribution<value> awgn(0, 1);
+	bool ok = true;
+	std::cout << std::fixed;
+	for (int bits : { 2, 3, 4, 6 }) {
+		for (value precision : { value(0.5), value(4), value(32) }) {
+			std::vector<cmplx> points(count);
+			value sigma = 1 / std::sqrt(2 * precision);
+			for (int i = 0; i < count; ++i) {
+				code_type b[6];
+				for (int k = 0; k < bits; ++k)
+					b[k] = rng() & 1 ? 1 : -1;
+				points[i] = point_map(bits, b) + sigma * cmplx(awgn(rng), awgn(rng));
+			}
+			// Ties of the rounding and values beyond the clamp
+			value scale = dist(bits) * precision;
+			for (int i = 0; i < count; i += 7)
+				points[i] = cmplx((int(rng() % 301) - 150 + value(0.5)) / scale, (int(rng() % 41) - 20 + value(0.5)) / scale);
+			std::vector<code_type> point_bits(bits * count), row_bits(bits * count);
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < count; ++i)
+				point_soft(bits, point_bits.data() + bits * i, points[i], precision);
+			std::chrono::duration<double> point_time = std::chrono::steady_clock::now() - start;
+			start = std::chrono::steady_clock::now();
+			for (int i = 0; i < count; i += row_len)
+				demapper_type::row(bits, row_bits.data() + bits * i, points.data() + i, row_len, precision);
+			std::chrono::duration<double> row_time = std::chrono::steady_clock::now() - start;
+			int diff = 0;
+			for (int i = 0; i < bits * count; ++i)
+				diff += point_bits[i] != row_bits[i];
+			std::cout << std::setw(2) << bits << " bits, precision " << std::setw(5) << std::setprecision(1) << precision
+				<< ": point " << std::setw(6) << std::setprecision(2) << point_time.count() * 1e9 / count
+				<< " ns, row " << std::setw(6) << row_time.count() * 1e9 / count << " ns per point, "
+				<< std::setw(5) << std::setprecision(1) << point_time.count() / row_time.count() << " x, "
+				<< diff << " soft bits differ" << std::endl;
+			ok &= !diff;
+		}
+	}
+	std::cout << (ok ? "bit-exact" : "MISMATCH") << std::endl;
+	return !ok;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file estimator_bench.cpp
+ * @brief Host benchmark of the robust slope estimators used for the phase correction
+ * 	- DSP::TheilSenEstimator, O(n²) memory
+ * 	- DSP::RepeatedMedianEstimator, O(n) memory
+ * 	- Fits noisy lines with a fraction of outliers, as seen on the pilot and data tones,
+ * 	  and reports the time per compute() and the RMS error of slope and intercept
+ * @note usage: estimator_bench [-r REPEAT]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "theil_sen.hh"
+#include "repeated_median.hh"
+
+typedef float value;
+
+// Carrier counts of the next (cols_max) and short (pay_car_cnt) decoders
+static const int len_max = 273 + 16;
+
+struct Result
+{
+	double seconds = 0;
+	double slope_err = 0;
+	double yint_err = 0;
+};
+
+template <typename ESTIMATOR>
+static Result run(ESTIMATOR &estimator, int len, value noise, value outliers, int repeat)
+{
+	std::minstd_rand rng(len);
+	std::normal_distribution<value> gauss(0, noise);
+	std::uniform_real_distribution<value> uniform(-M_PI, M_PI), coin(0, 1);
+	value x[len_max], y[len_max];
+	Result result;
+	for (int r = 0; r < repeat; ++r)
+	{
+		value slope = uniform(rng) / len, yint = uniform(rng) / 2;
+		for (int i = 0; i < len; ++i)
+		{
+			x[i] = i - len / 2;
+			y[i] = coin(rng) < outliers ? uniform(rng) : yint + slope * x[i] + gauss(rng);
+		}
+		auto start = std::chrono::steady_clock::now();
+		estimator.compute(x, y, len);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		result.seconds += elapsed.count();
+		result.slope_err += (estimator.slope() - slope) * (estimator.slope() - slope);
+		result.yint_err += (estimator.yint() - yint) * (estimator.yint() - yint);
+	}
+	result.seconds /= repeat;
+	result.slope_err = std::sqrt(result.slope_err / repeat);
+	result.yint_err = std::sqrt(result.yint_err / repeat);
+	return result;
+}
+
+static void report(const char *name, size_t bytes, const Result &result)
+{
+	std::cout << std::setw(16) << name << std::setw(8) << bytes / 1024 << " KiB"
+		<< std::setw(10) << std::fixed << std::setprecision(1) << result.seconds * 1e6 << " us"
+		<< "  slope " << std::scientific << std::setprecision(2) << result.slope_err
+		<< "  yint " << result.yint_err << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	int repeat = 100;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "-r") && i + 1 < argc)
+			repeat = std::max(1, std::atoi(argv[++i]));
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [-r REPEAT]" << std::endl;
+			return 1;
+		}
+	}
+	static DSP::TheilSenEstimator<value, len_max> theil_sen;
+	static DSP::RepeatedMedianEstimator<value, len_max> repeated_median;
+	static const int lens[] = { 16, 64, 256, len_max };
+	static const value noises[] = { 0.05, 0.2 };
+	static const value outliers[] = { 0, 0.1, 0.3 };
+	for (int len : lens)
+	{
+		for (value noise : noises)
+		{
+			for (value outlier : outliers)
+			{
+				std::cout << "n = " << len << ", noise = " << std::defaultfloat << noise
+					<< " rad, outliers = " << outlier * 100 << " %" << std::endl;
+				report("theil_sen", sizeof(theil_sen), run(theil_sen, len, noise, outlier, repeat));
+				report("repeated_median", sizeof(repeated_median), run(repeated_median, len, noise, outlier, repeat));
+			}
+		}
+	}
+	return 0;
+}
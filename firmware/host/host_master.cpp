@@ -0,0 +1,114 @@
+/**
+ * @file host_master.cpp
+ * @brief Host build of the OFDM modem from the "master" branch (operating modes 23..30)
+ * @note The master branch works on WAV files, so encode and decode go through temporary files.
+ * 	The reported timing therefore includes file I/O.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <cmath>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+#include "Rattlegram.h"
+#include "wav.hh"
+#include "host_modem.hh"
+
+class HostMaster : public HostModem
+{
+	static const int sample_rate = 8000;
+	static const int symbol_len = (1280 * sample_rate) / 8000;
+	std::string audio_name, payload_name;
+
+public:
+	HostMaster()
+	{
+		const char *tmp = getenv("TMPDIR");
+		std::string prefix = std::string(tmp ? tmp : "/tmp") + "/modem_bench_" + std::to_string(getpid());
+		audio_name = prefix + ".wav";
+		payload_name = prefix + ".bin";
+	}
+	~HostMaster()
+	{
+		unlink(audio_name.c_str());
+		unlink(payload_name.c_str());
+	}
+	const char *name() override
+	{
+		return "master";
+	}
+	int rate() override
+	{
+		return sample_rate;
+	}
+	int extended_len() override
+	{
+		return symbol_len + symbol_len / 8;
+	}
+	int mode_count() override
+	{
+		return 8;
+	}
+	int mode(int index) override
+	{
+		return 23 + index;
+	}
+	int payload_len(int mode) override
+	{
+		switch (mode) {
+		case 23:
+		case 26:
+			return 256;
+		case 24:
+		case 27:
+		case 29:
+			return 512;
+		case 25:
+		case 28:
+		case 30:
+			return 1024;
+		}
+		return 0;
+	}
+	bool encode(std::vector<int16_t> &audio, const uint8_t *payload, int len, int mode) override
+	{
+		if (!payload_len(mode) || len > payload_len(mode))
+			return false;
+		std::ofstream(payload_name, std::ios::binary | std::ios::trunc).write((const char *)payload, len);
+		std::string mode_arg = std::to_string(mode);
+		const char *argv[] = { "encode", audio_name.c_str(), "8000", "16", "1", "1600", mode_arg.c_str(), "NOCALL", payload_name.c_str() };
+		if (main_encode(sizeof(argv) / sizeof(argv[0]), const_cast<char **>(argv)))
+			return false;
+		DSP::ReadWAV<float> input_file(audio_name.c_str());
+		for (int i = 0; i < input_file.frames(); ++i)
+		{
+			float sample;
+			input_file.read(&sample, 1);
+			audio.push_back(std::nearbyint(32767 * sample));
+		}
+		return true;
+	}
+	int decode(uint8_t *payload, const int16_t *audio, int count) override
+	{
+		{
+			DSP::WriteWAV<float> output_file(audio_name.c_str(), sample_rate, 16, 1);
+			for (int i = 0; i < count; ++i)
+			{
+				float sample = audio[i] / 32767.f;
+				output_file.write(&sample, 1);
+			}
+		}
+		unlink(payload_name.c_str());
+		main_decode(audio_name.c_str(), payload_name.c_str());
+		std::ifstream input_file(payload_name, std::ios::binary);
+		input_file.read((char *)payload, payload_max);
+		int len = input_file.gcount();
+		return len ? len : -1;
+	}
+};
+
+HostModem *host_modem_master()
+{
+	return new HostMaster();
+}
@@ -0,0 +1,62 @@
+/**
+ * @file host_modem.hh
+ * @brief Common interface to the modem forks, so they can be built and benchmarked on a Linux host
+ * @note Every fork is compiled into its own shared library with hidden symbols, because the forks
+ * 	ship different versions of the same headers (simd.hh, complex.hh, psk.hh, ...).  Only the
+ * 	factory functions below are exported.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#define HOST_MODEM_EXPORT __attribute__((visibility("default")))
+
+struct HostModem
+{
+	static const int payload_max = 1024;
+
+	//! Name of the fork, e.g. "next"
+	virtual const char *name() = 0;
+	//! Audio sample rate in Hz
+	virtual int rate() = 0;
+	//! Number of samples in an OFDM symbol, including the guard interval
+	virtual int extended_len() = 0;
+	//! Number of operating modes that carry a payload
+	virtual int mode_count() = 0;
+	//! Operating mode at the given index
+	virtual int mode(int index) = 0;
+	//! Number of payload bytes carried by an operating mode
+	virtual int payload_len(int mode) = 0;
+	/**
+	 * @brief Encode a single packet, preceded and followed by silence
+	 * @param audio receives the 16-bit mono samples
+	 * @return false when the mode or payload is not supported
+	 */
+	virtual bool encode(std::vector<int16_t> &audio, const uint8_t *payload, int len, int mode) = 0;
+	/**
+	 * @brief Decode the first packet found in the audio
+	 * @param payload receives at most payload_max bytes
+	 * @return number of payload bytes, or -1 when no packet could be decoded
+	 */
+	virtual int decode(uint8_t *payload, const int16_t *audio, int count) = 0;
+	//! Clear the per-stage decoder profile (only when built with MODEM_PROFILE)
+	virtual void reset_profile() {}
+	//! Write the per-stage decoder profile as JSON
+	virtual void dump_profile(std::ostream &os)
+	{
+		os << "{}";
+	}
+	virtual ~HostModem() = default;
+};
+
+HOST_MODEM_EXPORT HostModem *host_modem_next();
+//! next decoder with the O(n) memory repeated median instead of Theil-Sen
+HOST_MODEM_EXPORT HostModem *host_modem_next_median();
+HOST_MODEM_EXPORT HostModem *host_modem_short();
+//! short decoder with the O(n) memory repeated median instead of Theil-Sen
+HOST_MODEM_EXPORT HostModem *host_modem_short_median();
+HOST_MODEM_EXPORT HostModem *host_modem_master();
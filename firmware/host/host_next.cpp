@@ -0,0 +1,124 @@
+/**
+ * @file host_next.cpp
+ * @brief Host build of the OFDM modem from the "next" branch (operating modes 20..30)
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <cstring>
+#include "encode.hh"
+#include "decode.hh"
+#include "host_modem.hh"
+
+typedef float value;
+typedef DSP::Complex<value> cmplx;
+
+static std::vector<int16_t> *sink_audio;
+
+static void sampleSink(int16_t samples[], int count)
+{
+	sink_audio->insert(sink_audio->end(), samples, samples + count);
+}
+
+template <template <typename, int> class SlopeEstimator>
+class HostNext : public HostModem
+{
+	const char *name_;
+	static const int sample_rate = 8000;
+	static const int freq_off = 1600;
+	static const int config_count = sizeof(modem_configs) / sizeof(modem_configs[0]);
+	Encoder<value, cmplx, sample_rate> *encoder;
+	Decoder<value, cmplx, sample_rate, SlopeEstimator> *decoder;
+
+	static const modem_config_t *config(int mode)
+	{
+		for (int i = 0; i < config_count; ++i)
+			if (modem_configs[i].oper_mode == mode)
+				return &modem_configs[i];
+		return nullptr;
+	}
+
+public:
+	HostNext(const char *name) : name_(name), encoder(new Encoder<value, cmplx, sample_rate>()), decoder(new Decoder<value, cmplx, sample_rate, SlopeEstimator>())
+	{
+		encoder->setSampleSink(sampleSink);
+	}
+	~HostNext()
+	{
+		delete encoder;
+		delete decoder;
+	}
+	const char *name() override
+	{
+		return name_;
+	}
+	int rate() override
+	{
+		return sample_rate;
+	}
+	int extended_len() override
+	{
+		return encoder->getSymbolLen() + encoder->getGuardLen();
+	}
+	// Mode 0 carries no payload, so it is left out
+	int mode_count() override
+	{
+		return config_count - 1;
+	}
+	int mode(int index) override
+	{
+		return modem_configs[index + 1].oper_mode;
+	}
+	int payload_len(int mode) override
+	{
+		const modem_config_t *modem_config = config(mode);
+		return modem_config && modem_config->code_order ? 1 << (modem_config->code_order - 4) : 0;
+	}
+	bool encode(std::vector<int16_t> &audio, const uint8_t *payload, int len, int mode) override
+	{
+		const modem_config_t *modem_config = config(mode);
+		if (!modem_config || !modem_config->code_order || !encoder->configure(freq_off, modem_config))
+			return false;
+		uint8_t data[payload_max];
+		std::memcpy(data, payload, len);
+		sink_audio = &audio;
+		encoder->silence_packet();
+		encoder->synchronization_symbol();
+		encoder->metadata_symbol(1);
+		bool okay = encoder->data_packet(data, len);
+		encoder->silence_packet();
+		encoder->silence_packet();
+		sink_audio = nullptr;
+		return okay;
+	}
+	int decode(uint8_t *payload, const int16_t *audio, int count) override
+	{
+		int block_len = decoder->getExtendedLen();
+		for (int i = 0; i + block_len <= count; i += block_len)
+		{
+			if (!decoder->feed(audio + i, block_len))
+				continue;
+			if (decoder->process() != STATUS_DONE)
+				continue;
+			return decoder->fetch(payload);
+		}
+		return -1;
+	}
+	void reset_profile() override
+	{
+		decoder->getProfile().reset();
+	}
+	void dump_profile(std::ostream &os) override
+	{
+		decoder->getProfile().dump(os);
+	}
+};
+
+HostModem *host_modem_next()
+{
+	return new HostNext<DSP::TheilSenEstimator>("next");
+}
+
+HostModem *host_modem_next_median()
+{
+	return new HostNext<DSP::RepeatedMedianEstimator>("next_median");
+}
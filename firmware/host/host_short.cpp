@@ -0,0 +1,114 @@
+/**
+ * @file host_short.cpp
+ * @brief Host build of the Rattlegram modem from the "short" branch (operating modes 14..16)
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include "encoder.hh"
+#include "decoder.hh"
+#include "host_modem.hh"
+
+template <template <typename, int> class SlopeEstimator>
+class HostShort : public HostModem
+{
+	const char *name_;
+	static const int sample_rate = 8000;
+	static const int carrier_frequency = 1600;
+	static const int symbol_length = (1280 * sample_rate) / 8000;
+	static const int extended_length = symbol_length + symbol_length / 8;
+	static const int data_max = 170;
+	Encoder<sample_rate> *encoder;
+	Decoder<sample_rate, SlopeEstimator> *decoder;
+
+public:
+	HostShort(const char *name) : name_(name), encoder(new Encoder<sample_rate>()), decoder(new Decoder<sample_rate, SlopeEstimator>()) {}
+	~HostShort()
+	{
+		delete encoder;
+		delete decoder;
+	}
+	const char *name() override
+	{
+		return name_;
+	}
+	int rate() override
+	{
+		return sample_rate;
+	}
+	int extended_len() override
+	{
+		return extended_length;
+	}
+	int mode_count() override
+	{
+		return 3;
+	}
+	int mode(int index) override
+	{
+		return 14 + index;
+	}
+	int payload_len(int mode) override
+	{
+		switch (mode) {
+		case 14:
+			return 170;
+		case 15:
+			return 128;
+		case 16:
+			return 85;
+		}
+		return 0;
+	}
+	// The encoder picks the mode from the length of the zero terminated payload
+	bool encode(std::vector<int16_t> &audio, const uint8_t *payload, int len, int mode) override
+	{
+		if (!payload_len(mode) || len != payload_len(mode))
+			return false;
+		uint8_t data[data_max + 1] = { 0 };
+		for (int i = 0; i < len; ++i)
+			if (!(data[i] = payload[i]))
+				return false;
+		encoder->configure(data, (const int8_t *)"NOCALL", carrier_frequency, 0, false);
+		int16_t block[extended_length];
+		for (int i = 0; i < extended_length; ++i)
+			block[i] = 0;
+		audio.insert(audio.end(), block, block + extended_length);
+		while (encoder->produce(block, 0))
+			audio.insert(audio.end(), block, block + extended_length);
+		for (int i = 0; i < 4; ++i)
+			audio.insert(audio.end(), block, block + extended_length);
+		return true;
+	}
+	int decode(uint8_t *payload, const int16_t *audio, int count) override
+	{
+		for (int i = 0; i + extended_length <= count; i += extended_length)
+		{
+			if (!decoder->feed(audio + i, extended_length, 0))
+				continue;
+			if (decoder->process() != STATUS_DONE)
+				continue;
+			float cfo;
+			int32_t mode;
+			uint8_t call[9];
+			decoder->staged(&cfo, &mode, call);
+			uint8_t data[data_max];
+			if (decoder->fetch(data) < 0)
+				return -1;
+			int len = payload_len(mode);
+			for (int j = 0; j < len; ++j)
+				payload[j] = data[j];
+			return len;
+		}
+		return -1;
+	}
+};
+
+HostModem *host_modem_short()
+{
+	return new HostShort<DSP::TheilSenEstimator>("short");
+}
+
+HostModem *host_modem_short_median()
+{
+	return new HostShort<DSP::RepeatedMedianEstimator>("short_median");
+}
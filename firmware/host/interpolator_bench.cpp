@@ -0,0 +1,228 @@
+/**
+ * @file interpolator_bench.cpp
+ * @brief Host accuracy check and benchmark of the interpolating output stage of the next encoder
+ * 	- Encoder<..., 8000, OUTPUT> synthesizes the symbols at 8 kHz and interpolates them to 8, 16, 44.1 or 48 kHz
+ * 	- Encoder<..., 48000> synthesizes the symbols at 48 kHz, for comparison
+ * 	- Reports the encoding time per symbol and decodes the output with a Decoder at the output rate,
+ * 	  the 48 kHz output also into the 8 kHz Decoder with an input_rate of 48 kHz, that decimates it.  All payloads must be decoded.
+ * 	- Reports the passband ripple of the interpolator over the band of the modem and its attenuation of the images
+ * @note usage: interpolator_bench [-n PACKETS] [-m MODE]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <vector>
+#include "encode.hh"
+#include "decode.hh"
+
+typedef float value;
+typedef DSP::Complex<value> cmplx;
+
+static const int freq_off = 1600;
+// Band of the modems around 1600 Hz, mode 29 and 30 occupy 1900 Hz
+static const value band_low = 600, band_high = 2600;
+
+static std::vector<int16_t> *sink_audio;
+static int sink_calls;
+
+static void sampleSink(int16_t samples[], int count)
+{
+	sink_audio->insert(sink_audio->end(), samples, samples + count);
+	++sink_calls;
+}
+
+//! Discards the diagnostic output of the encoder and decoder
+struct Quiet
+{
+	struct NullBuffer : std::streambuf
+	{
+		int overflow(int c) override
+		{
+			return c;
+		}
+	} null_buffer;
+	std::streambuf *err;
+	Quiet() : err(std::cerr.rdbuf(&null_buffer))
+	{
+	}
+	~Quiet()
+	{
+		std::cerr.rdbuf(err);
+	}
+};
+
+struct Packets
+{
+	const modem_config_t *config = nullptr;
+	std::vector<std::vector<uint8_t>> payloads;
+};
+
+struct Encoded
+{
+	std::vector<int16_t> audio;
+	int symbols = 0;
+	double seconds = 0;
+};
+
+template <int RATE, int OUTPUT>
+static Encoded encode(const Packets &packets)
+{
+	auto *encoder = new Encoder<value, cmplx, RATE, OUTPUT>();
+	Encoded encoded;
+	encoder->setSampleSink(sampleSink);
+	encoder->configure(freq_off, packets.config);
+	sink_audio = &encoded.audio;
+	sink_calls = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (auto &payload : packets.payloads) {
+		std::vector<uint8_t> data(payload);
+		encoder->synchronization_symbol();
+		encoder->metadata_symbol(1);
+		encoder->data_packet(data.data(), data.size());
+		encoder->silence_packet();
+		encoder->silence_packet();
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	encoded.seconds = elapsed.count();
+	encoded.symbols = sink_calls;
+	sink_audio = nullptr;
+	delete encoder;
+	return encoded;
+}
+
+//! Feeds whole blocks, followed by silence to flush the decoder, and counts the payloads that were sent
+template <int RATE, int INPUT_RATE = RATE>
+static int decode(const Packets &packets, const std::vector<int16_t> &audio)
+{
+	auto *decoder = new Decoder<value, cmplx, RATE, DefaultSlopeEstimator, INPUT_RATE>();
+	int feed_len = decoder->getInputLen();
+	int decoded = 0;
+	uint8_t payload[1024];
+	std::vector<int16_t> block(feed_len);
+	for (size_t i = 0; i < audio.size() + 16 * feed_len; i += feed_len) {
+		for (int j = 0; j < feed_len; ++j)
+			block[j] = i + j < audio.size() ? audio[i + j] : 0;
+		if (!decoder->feed(block.data(), feed_len) || decoder->process() != STATUS_DONE)
+			continue;
+		int len = decoder->fetch(payload);
+		for (auto &p : packets.payloads)
+			if (int(p.size()) == len && std::equal(p.begin(), p.end(), payload))
+				++decoded;
+	}
+	delete decoder;
+	return decoded;
+}
+
+//! Gain of the prototype filter in dB at the given frequency
+template <typename INTERPOLATOR>
+static value response(INTERPOLATOR &interpolator, value freq, value rate)
+{
+	const int up = INTERPOLATOR::up(), taps = INTERPOLATOR::taps();
+	value re = 0, im = 0;
+	for (int p = 0; p < up; ++p) {
+		for (int k = 0; k < taps; ++k) {
+			value c = interpolator.coefficients()[p * taps + k] / up;
+			value phi = 2 * DSP::Const<value>::Pi() * freq * (p + k * up) / (up * rate);
+			re += c * std::cos(phi);
+			im -= c * std::sin(phi);
+		}
+	}
+	return 10 * std::log10(re * re + im * im);
+}
+
+template <int OUTPUT>
+static void filter_report()
+{
+	static typename Encoder<value, cmplx, 8000, OUTPUT>::interpolator_type interpolator;
+	typedef decltype(interpolator) type;
+	value ripple = 0, image = -1000;
+	for (value f = band_low; f <= band_high; f += 10)
+		ripple = std::max(ripple, std::abs(response(interpolator, f, 8000)));
+	for (int k = 1; k * 8000 - band_high < OUTPUT / 2; ++k)
+		for (value f = band_low; f <= band_high; f += 10)
+			for (value i : { k * value(8000) - f, k * value(8000) + f })
+				if (i < OUTPUT / 2)
+					image = std::max(image, response(interpolator, i, 8000));
+	std::cout << std::setw(5) << OUTPUT << " Hz: " << type::up() << " / " << type::down() << ", "
+		<< type::up() * type::taps() << " taps, passband ripple " << std::setprecision(3) << ripple
+		<< " dB, image attenuation " << std::setprecision(1) << -image << " dB" << std::endl;
+}
+
+static void report(const char *name, const Encoded &reference, const Encoded &encoded, int decoded, int sent)
+{
+	std::cout << std::left << std::setw(24) << name << std::right << std::setw(8) << encoded.audio.size() / encoded.symbols
+		<< " samples/symbol " << std::setw(8) << std::setprecision(1) << encoded.seconds * 1e6 / encoded.symbols
+		<< " us/symbol " << std::setw(6) << std::setprecision(2) << encoded.seconds / reference.seconds << " x   decoded "
+		<< decoded << "/" << sent << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	int count = 10;
+	int mode = 29;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+			count = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "-m") && i + 1 < argc)
+			mode = std::atoi(argv[++i]);
+		else {
+			std::cerr << "usage: " << argv[0] << " [-n PACKETS] [-m MODE]" << std::endl;
+			return 1;
+		}
+	}
+	Packets packets;
+	for (auto &c : modem_configs)
+		if (c.oper_mode == mode && c.code_order)
+			packets.config = &c;
+	if (!packets.config) {
+		std::cerr << "unknown mode " << mode << std::endl;
+		return 1;
+	}
+	std::mt19937 rng(42);
+	for (int i = 0; i < count; ++i) {
+		std::vector<uint8_t> payload(1 << (packets.config->code_order - 4));
+		for (auto &b : payload)
+			b = rng();
+		packets.payloads.push_back(payload);
+	}
+	std::cout << "mode " << mode << ", " << count << " packets" << std::endl << std::fixed;
+
+	std::cout << "interpolator, 16 taps per phase:" << std::endl;
+	filter_report<16000>();
+	filter_report<44100>();
+	filter_report<48000>();
+
+	Quiet *quiet = new Quiet;
+	Encoded enc8 = encode<8000, 8000>(packets);
+	Encoded enc16 = encode<8000, 16000>(packets);
+	Encoded enc44 = encode<8000, 44100>(packets);
+	Encoded enc48 = encode<8000, 48000>(packets);
+	Encoded full48 = encode<48000, 48000>(packets);
+	int dec8 = decode<8000>(packets, enc8.audio);
+	int dec16 = decode<16000>(packets, enc16.audio);
+	int dec44 = decode<44100>(packets, enc44.audio);
+	int dec48 = decode<48000>(packets, enc48.audio);
+	int full = decode<48000>(packets, full48.audio);
+	int decimated = decode<8000, 48000>(packets, enc48.audio);
+	delete quiet;
+
+	std::cout << "encoder:" << std::endl;
+	report("8 kHz", enc8, enc8, dec8, count);
+	report("8 kHz -> 16 kHz", enc8, enc16, dec16, count);
+	report("8 kHz -> 44.1 kHz", enc8, enc44, dec44, count);
+	report("8 kHz -> 48 kHz", enc8, enc48, dec48, count);
+	report("48 kHz", enc8, full48, full, count);
+	std::cout << "8 kHz -> 48 kHz, decimated back to 8 kHz: decoded " << decimated << "/" << count << std::endl;
+	bool ok = dec8 == count && dec16 == count && dec44 == count && dec48 == count && full == count && decimated == count;
+	std::cout << (ok ? "all decoded" : "DECODING FAILED") << std::endl;
+	return !ok;
+}
@@ -0,0 +1,255 @@
+/**
+ * @file link_bench.cpp
+ * @brief Host calibration of the link adaptation of the next modem
+ * 	- Encodes PACKETS packets in every mode with payload and decodes them with white noise from 30 dB SNR downwards,
+ * 	  the SNR being relative to the power of the signal over the whole audio band at 8 kHz
+ * 	- Reports the packet error rate and the mean Decoder::getEsN0() at each SNR, and prints the link_thresholds table
+ * 	  of link_adaptation.hh: the SNR at the target packet error rate and the offset of the Es/N0 of the decoder
+ * 	- Then feeds LinkAdaptation with the Es/N0 of the frames of the most robust mode at each SNR, and compares its
+ * 	  choice to the mode with the highest throughput that met the target.  The chosen modes must meet it.
+ * @note usage: link_bench [-n PACKETS] [-t PER]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <vector>
+#include "encode.hh"
+#include "decode.hh"
+#include "link_adaptation.hh"
+
+typedef float value;
+typedef DSP::Complex<value> cmplx;
+
+static const int sample_rate = 8000;
+static const int freq_off = 1600;
+static const int block_len = 1440;
+
+static std::vector<int16_t> *sink_audio;
+
+static void sampleSink(int16_t samples[], int count)
+{
+	sink_audio->insert(sink_audio->end(), samples, samples + count);
+}
+
+//! Discards the diagnostic output of the encoder and decoder
+struct Quiet
+{
+	struct NullBuffer : std::streambuf
+	{
+		int overflow(int c) override
+		{
+			return c;
+		}
+	} null_buffer;
+	std::streambuf *err;
+	Quiet() : err(std::cerr.rdbuf(&null_buffer))
+	{
+	}
+	~Quiet()
+	{
+		std::cerr.rdbuf(err);
+	}
+};
+
+struct Packets
+{
+	const modem_config_t *config = nullptr;
+	std::vector<int16_t> audio;
+	std::vector<std::vector<uint8_t>> payloads;
+	double power = 0;
+};
+
+struct Point
+{
+	int snr;
+	int decoded = 0;
+	std::vector<value> esn0;
+};
+
+static void encode(Packets &packets, int count)
+{
+	auto *encoder = new Encoder<value, cmplx, sample_rate>();
+	sink_audio = &packets.audio;
+	encoder->setSampleSink(sampleSink);
+	encoder->configure(freq_off, packets.config);
+	int len = encoder->getPacketSize();
+	std::mt19937 rng(42);
+	encoder->silence_packet();
+	for (int i = 0; i < count; ++i) {
+		std::vector<uint8_t> payload(len);
+		for (auto &b : payload)
+			b = rng();
+		encoder->synchronization_symbol();
+		encoder->metadata_symbol(1);
+		encoder->data_packet(payload.data(), len);
+		encoder->silence_packet();
+		packets.payloads.push_back(payload);
+	}
+	encoder->silence_packet();
+	sink_audio = nullptr;
+	delete encoder;
+	int active = 0;
+	for (int16_t x : packets.audio)
+		if (x)
+			packets.power += double(x) * x, ++active;
+	packets.power /= active;
+}
+
+static Point decode(const Packets &packets, int snr)
+{
+	auto *decoder = new Decoder<value, cmplx, sample_rate>();
+	Point point;
+	point.snr = snr;
+	std::mt19937 rng(snr + 100);
+	std::normal_distribution<double> awgn(0, std::sqrt(packets.power / std::pow(10, snr / 10.0)));
+	uint8_t payload[1024];
+	std::vector<int16_t> block(block_len);
+	for (size_t i = 0; i < packets.audio.size() + 4 * block_len; i += block_len) {
+		for (int j = 0; j < block_len; ++j) {
+			double x = (i + j < packets.audio.size() ? packets.audio[i + j] : 0) + awgn(rng);
+			block[j] = std::min<double>(std::max<double>(std::nearbyint(x), -32768), 32767);
+		}
+		if (!decoder->feed(block.data(), block_len) || decoder->process() != STATUS_DONE)
+			continue;
+		point.esn0.push_back(decoder->getEsN0());
+		int len = decoder->fetch(payload);
+		for (auto &p : packets.payloads)
+			if (len > 0 && std::equal(p.begin(), p.begin() + std::min<int>(len, p.size()), payload))
+				++point.decoded;
+	}
+	delete decoder;
+	return point;
+}
+
+static value mean(const std::vector<value> &v)
+{
+	value sum = 0;
+	for (value x : v)
+		sum += x;
+	return v.empty() ? 0 : sum / v.size();
+}
+
+struct Mode
+{
+	const modem_config_t *config;
+	std::vector<Point> points;
+	link_threshold_t calibration;
+	double per(int snr, int count) const
+	{
+		for (auto &p : points)
+			if (p.snr == snr)
+				return 1 - double(p.decoded) / count;
+		return snr > points.front().snr ? 0 : 1;
+	}
+};
+
+int main(int argc, char **argv)
+{
+	int count = 20;
+	double target = 0.1;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+			count = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "-t") && i + 1 < argc)
+			target = std::atof(argv[++i]);
+		else {
+			std::cerr << "usage: " << argv[0] << " [-n PACKETS] [-t PER]" << std::endl;
+			return 1;
+		}
+	}
+	std::cout << count << " packets per mode and SNR, target packet error rate " << target << std::endl << std::fixed;
+	std::vector<Mode> modes;
+	for (auto &c : modem_configs) {
+		if (!c.code_order)
+			continue;
+		Packets packets;
+		packets.config = &c;
+		Mode mode;
+		mode.config = &c;
+		{
+			Quiet quiet;
+			encode(packets, count);
+			// Down to two steps without any packet decoded
+			for (int snr = 30, misses = 0; misses < 2 && snr > -10; --snr) {
+				mode.points.push_back(decode(packets, snr));
+				misses = mode.points.back().decoded ? 0 : misses + 1;
+			}
+		}
+		// Lowest SNR above which every step meets the target, interpolated between the steps
+		auto &points = mode.points;
+		size_t pass = 0;
+		while (pass + 1 < points.size() && 1 - double(points[pass + 1].decoded) / count <= target)
+			++pass;
+		value snr_min = points[pass].snr;
+		if (pass + 1 < points.size()) {
+			double per_pass = 1 - double(points[pass].decoded) / count;
+			double per_fail = 1 - double(points[pass + 1].decoded) / count;
+			snr_min -= (target - per_pass) / (per_fail - per_pass);
+		}
+		// The Es/N0 of the decoder reads high below the threshold, so only the 10 dB above it count
+		std::vector<value> offsets;
+		for (auto &p : points)
+			if (p.snr >= snr_min && p.snr <= snr_min + 10 && !p.esn0.empty())
+				offsets.push_back(mean(p.esn0) - p.snr);
+		mode.calibration = { c.oper_mode, mean(offsets), snr_min };
+		std::cout << "mode " << c.oper_mode << ", " << std::setprecision(1)
+			<< LinkAdaptation<value>::throughput(&c) << " bytes/symbol" << std::endl << "   SNR:";
+		for (auto &p : points)
+			std::cout << std::setw(6) << p.snr;
+		std::cout << std::endl << "   PER:";
+		for (auto &p : points)
+			std::cout << std::setw(6) << std::setprecision(2) << 1 - double(p.decoded) / count;
+		std::cout << std::endl << " Es/N0:";
+		for (auto &p : points)
+			std::cout << std::setw(6) << std::setprecision(1) << mean(p.esn0);
+		std::cout << std::endl;
+		modes.push_back(mode);
+	}
+
+	std::cout << std::endl << "static const link_threshold_t link_thresholds[] =" << std::endl << "{" << std::endl;
+	for (size_t i = 0; i < modes.size(); ++i) {
+		auto &t = modes[i].calibration;
+		std::cout << "\t{ " << t.oper_mode << ", " << std::setprecision(1) << t.esn0_offset << ", " << t.snr_min
+			<< (i + 1 < modes.size() ? " }," : " }") << std::endl;
+	}
+	std::cout << "};" << std::endl << std::endl;
+
+	// The most robust mode probes the channel
+	const Mode *robust = &modes.front();
+	for (auto &m : modes)
+		if (m.calibration.snr_min < robust->calibration.snr_min)
+			robust = &m;
+	std::cout << "frames of mode " << robust->config->oper_mode << " into LinkAdaptation, margin "
+		<< std::setprecision(1) << LinkAdaptation<value>().getMargin() << " dB" << std::endl;
+	std::cout << "   SNR  estimate  chosen    PER   best" << std::endl;
+	bool ok = true;
+	for (auto &p : robust->points) {
+		LinkAdaptation<value> link;
+		for (value esn0 : p.esn0)
+			link.update(1, robust->config->oper_mode, esn0);
+		int chosen = link.getMode(1);
+		const Mode *best = nullptr;
+		double chosen_per = 1;
+		for (auto &m : modes) {
+			double per = m.per(p.snr, count);
+			if (m.config->oper_mode == chosen)
+				chosen_per = per;
+			if (per <= target && (!best || LinkAdaptation<value>::throughput(m.config) > LinkAdaptation<value>::throughput(best->config)))
+				best = &m;
+		}
+		std::cout << std::setw(6) << p.snr << std::setw(10) << std::setprecision(1) << link.getSnr(1)
+			<< std::setw(8) << chosen << std::setw(7) << std::setprecision(2) << chosen_per
+			<< std::setw(7) << (best ? best->config->oper_mode : 0) << std::endl;
+		// A choice for a known peer must meet the target, where any mode does
+		ok &= !best || !p.esn0.size() || chosen_per <= target;
+	}
+	return !ok;
+}
@@ -0,0 +1,164 @@
+/**
+ * @file modem_bench.cpp
+ * @brief Host benchmark of the modem forks
+ * 	- Encodes one packet per operating mode, decodes it again and checks the payload
+ * 	- Reports throughput in samples/s, the real-time factor and the time per OFDM symbol
+ * 	- With -p, prints the per-stage decoder profile as JSON (needs -DMODEM_PROFILE=ON)
+ * @note usage: modem_bench [-r REPEAT] [-v] [-p] [next|next_median|short|short_median|master]..
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+#include "host_modem.hh"
+
+/// @brief Discards everything the modems print to std::cout and std::cerr while being timed
+class Quiet
+{
+	struct NullBuffer : std::streambuf
+	{
+		int overflow(int c) override
+		{
+			return c;
+		}
+	} null_buffer;
+	std::streambuf *out, *err;
+
+public:
+	Quiet(bool verbose) : out(std::cout.rdbuf()), err(std::cerr.rdbuf())
+	{
+		if (verbose)
+			return;
+		std::cout.rdbuf(&null_buffer);
+		std::cerr.rdbuf(&null_buffer);
+	}
+	~Quiet()
+	{
+		std::cout.rdbuf(out);
+		std::cerr.rdbuf(err);
+	}
+};
+
+template <typename FUNC>
+static double best_of(int repeat, FUNC func)
+{
+	double best = 0;
+	for (int i = 0; i < repeat; ++i)
+	{
+		auto start = std::chrono::steady_clock::now();
+		func();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		if (!i || elapsed.count() < best)
+			best = elapsed.count();
+	}
+	return best;
+}
+
+static void report(const char *what, double seconds, int samples, int rate, int symbols)
+{
+	std::printf(" %s %10.0f S/s %7.3f RTF %9.1f us/sym", what, samples / seconds, seconds * rate / samples, 1e6 * seconds / symbols);
+}
+
+static int bench(HostModem *modem, int repeat, bool verbose, bool profile)
+{
+	int failures = 0;
+	for (int index = 0; index < modem->mode_count(); ++index)
+	{
+		int mode = modem->mode(index);
+		int len = modem->payload_len(mode);
+		uint8_t payload[HostModem::payload_max], decoded[HostModem::payload_max];
+		for (int i = 0; i < len; ++i)
+			payload[i] = ' ' + 1 + (i * 7 + mode) % 94;
+		std::vector<int16_t> audio;
+		bool encoded = true;
+		int result = -1;
+		double enc_time = 0, dec_time = 0;
+		{
+			Quiet quiet(verbose);
+			enc_time = best_of(repeat, [&]() {
+				audio.clear();
+				encoded = modem->encode(audio, payload, len, mode);
+			});
+			modem->reset_profile();
+			if (encoded)
+				dec_time = best_of(repeat, [&]() {
+					result = modem->decode(decoded, audio.data(), audio.size());
+				});
+		}
+		std::printf("%-6s mode %2d %4d bytes", modem->name(), mode, len);
+		if (!encoded)
+		{
+			std::printf(" encoding failed\n");
+			++failures;
+			continue;
+		}
+		int samples = audio.size();
+		int symbols = samples / modem->extended_len();
+		std::printf(" %3d sym", symbols);
+		report("enc", enc_time, samples, modem->rate(), symbols);
+		report(" dec", dec_time, samples, modem->rate(), symbols);
+		bool okay = result == len && !std::memcmp(payload, decoded, len);
+		std::printf(" %s\n", okay ? "ok" : "FAIL");
+		if (profile)
+		{
+			std::fflush(stdout);
+			modem->dump_profile(std::cout);
+			std::cout << std::endl;
+		}
+		failures += !okay;
+	}
+	return failures;
+}
+
+int main(int argc, char **argv)
+{
+	int repeat = 3;
+	bool verbose = false;
+	bool profile = false;
+	std::vector<const char *> forks;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "-r") && i + 1 < argc)
+			repeat = std::max(1, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "-v"))
+			verbose = true;
+		else if (!std::strcmp(argv[i], "-p"))
+			profile = true;
+		else
+			forks.push_back(argv[i]);
+	}
+	if (forks.empty())
+		forks = { "next", "short", "master" };
+	int failures = 0;
+	for (const char *fork : forks)
+	{
+		HostModem *modem;
+		{
+			Quiet quiet(verbose);
+			if (!std::strcmp(fork, "next"))
+				modem = host_modem_next();
+			else if (!std::strcmp(fork, "next_median"))
+				modem = host_modem_next_median();
+			else if (!std::strcmp(fork, "short"))
+				modem = host_modem_short();
+			else if (!std::strcmp(fork, "short_median"))
+				modem = host_modem_short_median();
+			else if (!std::strcmp(fork, "master"))
+				modem = host_modem_master();
+			else
+				modem = nullptr;
+		}
+		if (!modem)
+		{
+			std::cerr << "usage: " << argv[0] << " [-r REPEAT] [-v] [-p] [next|next_median|short|short_median|master].." << std::endl;
+			return 1;
+		}
+		failures += bench(modem, repeat, verbose, profile);
+		delete modem;
+	}
+	return failures != 0;
+}
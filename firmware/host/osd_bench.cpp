@@ -0,0 +1,111 @@
+/**
+ * @file osd_bench.cpp
+ * @brief Host benchmark of the ordered statistics decoders for the BCH(255,71) preamble code of the next decoder
+ * 	- CODE::OrderedStatisticsDecoder, one byte per bit, order 2 as used so far
+ * 	- CODE::PackedOrderedStatisticsDecoder, 64 bits per word, orders 2 to 4
+ * 	- Checks that both decoders agree at the same order and reports time per call and frame success rate
+ * @note usage: osd_bench [-f FRAMES] [-s SNR_DB]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "osd.hh"
+
+static const int N = 255, K = 71;
+
+struct Frame
+{
+	uint8_t code[(N+7)/8];
+	int8_t soft[N];
+};
+
+template <typename DECODER>
+static void bench(const char *name, DECODER &osd, const int8_t *genmat, const Frame *frames, int count, uint8_t *out)
+{
+	int okay = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int f = 0; f < count; ++f) {
+		uint8_t *hard = out + f * (N+7)/8;
+		if (osd(hard, frames[f].soft, genmat) && std::equal(hard, hard + (N+7)/8, frames[f].code))
+			++okay;
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << std::setw(10) << name << std::setw(8) << std::fixed << std::setprecision(1)
+		<< elapsed.count() / count * 1e6 << " us  " << std::setw(6) << std::setprecision(2)
+		<< 100.0 * okay / count << " % okay" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	int frames = 1000;
+	double snr = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "-f") && i + 1 < argc)
+			frames = std::max(1, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "-s") && i + 1 < argc)
+			snr = std::atof(argv[++i]);
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [-f FRAMES] [-s SNR_DB]" << std::endl;
+			return 1;
+		}
+	}
+	static int8_t genmat[N*K];
+	CODE::BoseChaudhuriHocquenghemGenerator<N, K>::matrix(genmat, true, {
+		0b100011101, 0b101110111, 0b111110011, 0b101101001,
+		0b110111101, 0b111100111, 0b100101011, 0b111010111,
+		0b000010011, 0b101100101, 0b110001011, 0b101100011,
+		0b100011011, 0b100111111, 0b110001101, 0b100101101,
+		0b101011111, 0b111111001, 0b111000011, 0b100111001,
+		0b110101001, 0b000011111, 0b110000111, 0b110110001});
+	CODE::LinearEncoder<N, K> encode;
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<int> coin(0, 1);
+	// SNR per code bit
+	std::normal_distribution<double> awgn(0, std::sqrt(0.5 * std::pow(10, -snr / 10)));
+	Frame *frame = new Frame[frames];
+	for (int f = 0; f < frames; ++f) {
+		uint8_t mesg[(K+7)/8] = { 0 };
+		for (int i = 0; i < K; ++i)
+			CODE::set_be_bit(mesg, i, coin(rng));
+		encode(frame[f].code, mesg, genmat);
+		for (int i = 0; i < N; ++i) {
+			double sym = 1 - 2 * CODE::get_be_bit(frame[f].code, i) + awgn(rng);
+			frame[f].soft[i] = std::min<double>(std::max<double>(std::nearbyint(64 * sym), -127), 127);
+		}
+	}
+	std::cout << frames << " frames at " << snr << " dB" << std::endl;
+	uint8_t *byte2 = new uint8_t[frames * (N+7)/8];
+	uint8_t *packed2 = new uint8_t[frames * (N+7)/8];
+	uint8_t *scratch = new uint8_t[frames * (N+7)/8];
+	auto *osd2 = new CODE::OrderedStatisticsDecoder<N, K, 2>;
+	auto *posd2 = new CODE::PackedOrderedStatisticsDecoder<N, K, 2>;
+	auto *posd3 = new CODE::PackedOrderedStatisticsDecoder<N, K, 3>;
+	auto *posd4 = new CODE::PackedOrderedStatisticsDecoder<N, K, 4>;
+	bench("byte O=2", *osd2, genmat, frame, frames, byte2);
+	bench("packed O=2", *posd2, genmat, frame, frames, packed2);
+	bench("packed O=3", *posd3, genmat, frame, frames, scratch);
+	bench("packed O=4", *posd4, genmat, frame, frames, scratch);
+	bool same = std::equal(byte2, byte2 + frames * (N+7)/8, packed2);
+	std::cout << "byte and packed at order 2: " << (same ? "same" : "DIFFERENT") << std::endl;
+	std::cout << "RAM: byte " << sizeof(*osd2) << " bytes, packed " << sizeof(*posd2) << " bytes" << std::endl;
+	delete osd2;
+	delete posd2;
+	delete posd3;
+	delete posd4;
+	delete[] byte2;
+	delete[] packed2;
+	delete[] scratch;
+	delete[] frame;
+	return !same;
+}
@@ -0,0 +1,294 @@
+/**
+ * @file pipeline_bench.cpp
+ * @brief Host benchmark of the receive pipeline of the next decoder with back to back packets
+ * 	- A std::thread plays the audio into a SpscRing of 4096 samples, as long as the ring of the I2S reader task at 48 kHz, paced at SPEEDUP times real-time
+ * 	- sequential: one thread runs Decoder::feed(), process() and fetch(), samples get lost while fetch() is busy
+ * 	- pipelined: RxPipeline, the front end (DC blocker, Hilbert filter, correlator) keeps reading the samples,
+ * 	  while the back end runs the demodulation and FEC on the queued blocks
+ * 	- deferred: SquelchCapture, the front end only stores the packets that break the squelch, the back end decodes them later
+ * 	- Reports the packets decoded, the samples lost in the ring and the blocks (pipelined) or frames (deferred) dropped,
+ * 	  for deferred also the queue depth and the latency from the end of the capture to the end of the decoding
+ * 	- GAP seconds of weak noise between the packets let the squelch close
+ * @note usage: pipeline_bench [-n PACKETS] [-m MODE] [-x SPEEDUP] [-g GAP]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <thread>
+#include <vector>
+#include "encode.hh"
+#include "rx_pipeline.hh"
+#include "squelch_capture.hh"
+
+typedef float value;
+typedef DSP::Complex<value> cmplx;
+
+static const int sample_rate = 8000;
+static const int freq_off = 1600;
+typedef SpscRing<int16_t, 4096> SampleRing;
+typedef RxPipeline<value, cmplx, sample_rate> Pipeline;
+typedef SquelchCapture<value, cmplx, sample_rate> Capture;
+static const int block_len = Pipeline::extended_len;
+
+static std::vector<int16_t> *sink_audio;
+
+static void sampleSink(int16_t samples[], int count)
+{
+	sink_audio->insert(sink_audio->end(), samples, samples + count);
+}
+
+//! Discards the diagnostic output of the decoder
+struct Quiet
+{
+	struct NullBuffer : std::streambuf
+	{
+		int overflow(int c) override
+		{
+			return c;
+		}
+	} null_buffer;
+	std::streambuf *err;
+	Quiet() : err(std::cerr.rdbuf(&null_buffer))
+	{
+	}
+	~Quiet()
+	{
+		std::cerr.rdbuf(err);
+	}
+};
+
+struct Packets
+{
+	std::vector<int16_t> audio;
+	std::vector<std::vector<uint8_t>> payloads;
+
+	bool contains(const uint8_t *payload, int len) const
+	{
+		for (auto &p : payloads)
+			if (int(p.size()) == len && std::equal(p.begin(), p.end(), payload))
+				return true;
+		return false;
+	}
+};
+
+struct Result
+{
+	int decoded = 0;
+	uint32_t lost_samples = 0;
+	uint32_t dropped = 0;
+	double seconds = 0;
+};
+
+static bool encode(Packets &packets, int count, int mode, double gap)
+{
+	const modem_config_t *config = nullptr;
+	for (auto &c : modem_configs)
+		if (c.oper_mode == mode && c.code_order)
+			config = &c;
+	auto *encoder = new Encoder<value, cmplx, sample_rate>();
+	encoder->setSampleSink(sampleSink);
+	if (!config || !encoder->configure(freq_off, config)) {
+		delete encoder;
+		return false;
+	}
+	int len = 1 << (config->code_order - 4);
+	std::mt19937 rng(42);
+	sink_audio = &packets.audio;
+	// One second of noise before and after the packets, for the squelch to learn the noise floor and close again
+	packets.audio.resize(sample_rate);
+	encoder->silence_packet();
+	for (int i = 0; i < count; ++i) {
+		std::vector<uint8_t> payload(len);
+		for (auto &b : payload)
+			b = rng();
+		encoder->synchronization_symbol();
+		encoder->metadata_symbol(1);
+		encoder->data_packet(payload.data(), len);
+		packets.payloads.push_back(payload);
+		packets.audio.resize(packets.audio.size() + int(gap * sample_rate));
+	}
+	encoder->silence_packet();
+	encoder->silence_packet();
+	packets.audio.resize(packets.audio.size() + sample_rate);
+	// Noise floor for the squelch, about 60 dB below full scale
+	std::normal_distribution<float> awgn(0, 8);
+	for (auto &sample : packets.audio)
+		sample = std::min<float>(std::max<float>(std::nearbyint(sample + awgn(rng)), -32768), 32767);
+	// Whole blocks only
+	packets.audio.resize(packets.audio.size() / block_len * block_len);
+	sink_audio = nullptr;
+	delete encoder;
+	return true;
+}
+
+//! Plays the audio into the ring in blocks of 64 samples, like the I2S DMA, without ever waiting for the consumer
+static void play(SampleRing &ring, const std::vector<int16_t> &audio, double speedup, bool &done)
+{
+	const int dma_len = 64;
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < audio.size(); i += dma_len) {
+		std::this_thread::sleep_until(start + std::chrono::duration<double>(i / (sample_rate * speedup)));
+		ring.write(audio.data() + i, std::min<size_t>(dma_len, audio.size() - i));
+	}
+	__atomic_store_n(&done, true, __ATOMIC_RELEASE);
+}
+
+//! Reads a whole block from the ring, false once the player is done and the ring is empty
+static bool read_block(SampleRing &ring, int16_t *block, const bool &done)
+{
+	int filled = 0;
+	while (filled < block_len) {
+		int n = ring.read(block + filled, block_len - filled);
+		if (!n) {
+			if (__atomic_load_n(&done, __ATOMIC_ACQUIRE) && !ring.available())
+				return false;
+			std::this_thread::yield();
+		}
+		filled += n;
+	}
+	return true;
+}
+
+static Result sequential(const Packets &packets, double speedup)
+{
+	static SampleRing ring;
+	auto *decoder = new Decoder<value, cmplx, sample_rate>();
+	Result result;
+	bool done = false;
+	auto start = std::chrono::steady_clock::now();
+	std::thread player(play, std::ref(ring), std::cref(packets.audio), speedup, std::ref(done));
+	int16_t block[block_len];
+	uint8_t payload[1024];
+	while (read_block(ring, block, done)) {
+		if (!decoder->feed(block, block_len) || decoder->process() != STATUS_DONE)
+			continue;
+		int len = decoder->fetch(payload);
+		result.decoded += len > 0 && packets.contains(payload, len);
+	}
+	player.join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	result.seconds = elapsed.count();
+	result.lost_samples = ring.overruns();
+	delete decoder;
+	return result;
+}
+
+static uint32_t dropped(Pipeline *pipeline)
+{
+	return pipeline->getOverruns();
+}
+
+static uint32_t dropped(Capture *capture)
+{
+	return capture->getDroppedFrames();
+}
+
+//! Front end in its own thread, back end in this one
+template <typename PIPELINE>
+static Result threaded(PIPELINE *pipeline, const Packets &packets, double speedup)
+{
+	static SampleRing ring;
+	Result result;
+	bool done = false, front_done = false;
+	auto start = std::chrono::steady_clock::now();
+	std::thread player(play, std::ref(ring), std::cref(packets.audio), speedup, std::ref(done));
+	std::thread frontend([&]() {
+		int16_t block[block_len];
+		while (read_block(ring, block, done))
+			pipeline->frontend(block, block_len);
+		__atomic_store_n(&front_done, true, __ATOMIC_RELEASE);
+	});
+	uint8_t payload[1024];
+	while (true) {
+		bool last = __atomic_load_n(&front_done, __ATOMIC_ACQUIRE);
+		int status = pipeline->backend();
+		if (status < 0) {
+			if (last)
+				break;
+			std::this_thread::yield();
+			continue;
+		}
+		if (status != STATUS_DONE)
+			continue;
+		int len = pipeline->getDecoder().fetch(payload);
+		result.decoded += len > 0 && packets.contains(payload, len);
+	}
+	player.join();
+	frontend.join();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	result.seconds = elapsed.count();
+	result.lost_samples = ring.overruns();
+	result.dropped = dropped(pipeline);
+	return result;
+}
+
+static void report(const char *name, const Result &result, int count, double audio_seconds)
+{
+	std::cout << std::setw(12) << name << std::setw(4) << result.decoded << "/" << count << " packets"
+		<< std::setw(9) << result.lost_samples << " samples lost" << std::setw(5) << result.dropped << " dropped"
+		<< std::setw(8) << std::fixed << std::setprecision(2) << result.seconds << " s, RTF "
+		<< std::setprecision(3) << result.seconds / audio_seconds << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+	int count = 10, mode = 28;
+	double speedup = 200, gap = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+			count = std::max(1, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "-m") && i + 1 < argc)
+			mode = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "-x") && i + 1 < argc)
+			speedup = std::max(0.1, std::atof(argv[++i]));
+		else if (!std::strcmp(argv[i], "-g") && i + 1 < argc)
+			gap = std::max(0.0, std::atof(argv[++i]));
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [-n PACKETS] [-m MODE] [-x SPEEDUP] [-g GAP]" << std::endl;
+			return 1;
+		}
+	}
+	Packets packets;
+	bool okay;
+	{
+		Quiet quiet;
+		okay = encode(packets, count, mode, gap);
+	}
+	if (!okay) {
+		std::cerr << "mode " << mode << " unsupported." << std::endl;
+		return 1;
+	}
+	double audio_seconds = double(packets.audio.size()) / sample_rate;
+	std::cout << count << " packets of mode " << mode << ", " << std::fixed << std::setprecision(1) << gap << " s apart, "
+		<< audio_seconds << " s of audio played at " << speedup << " times real-time" << std::endl;
+	Result seq, pipe, defer;
+	auto *pipeline = new Pipeline();
+	auto *capture = new Capture();
+	{
+		Quiet quiet;
+		seq = sequential(packets, speedup);
+		pipe = threaded(pipeline, packets, speedup);
+		defer = threaded(capture, packets, speedup);
+	}
+	report("sequential", seq, count, audio_seconds);
+	report("pipelined", pipe, count, audio_seconds);
+	report("deferred", defer, count, audio_seconds);
+	std::cout << std::setw(12) << "" << "frames: " << capture->getCapturedFrames() << " captured, " << capture->getEmptyFrames()
+		<< " empty, max queue depth " << capture->getMaxQueueDepth() << ", latency mean " << capture->getMeanLatencyMs()
+		<< " ms, max " << capture->getMaxLatencyMs() << " ms of audio time, store " << capture->getStoreSize() / 1024 << " KiB" << std::endl;
+	delete pipeline;
+	delete capture;
+	// Without the pipeline, losing packets at high speedups is expected
+	return (pipe.decoded != count && !pipe.lost_samples && !pipe.dropped)
+		|| (defer.decoded != count && !defer.lost_samples && !defer.dropped);
+}
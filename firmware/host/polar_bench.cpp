@@ -0,0 +1,107 @@
+/**
+ * @file polar_bench.cpp
+ * @brief Host check and benchmark of the bit-packed polar encoder of the next and master encoders
+ * 	- nrz: PolarParityEncoder, one int8_t NRZ value per bit, the message converted bit by bit with get_le_bit,
+ * 	  as the encoders did before
+ * 	- packed: PolarParityPackedEncoder on 32 bit words, the message packed from the bytes and the codeword
+ * 	  converted to NRZ afterwards with unpack()
+ * 	- Random messages with their CRC32 for the codes of order 10 to 14 of the next encoder.
+ * 	  Both codewords must be identical.
+ * @note usage: polar_bench [-n REPEATS]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "bitman.hh"
+#include "crc.hh"
+#include "polar_tables.hh"
+#include "polar_parity_aided.hh"
+#include "polar_parity_packed.hh"
+
+typedef int8_t code_type;
+
+static const int bits_max = 1 << 14;
+
+static int nrz(bool bit)
+{
+	return 1 - 2 * bit;
+}
+
+int main(int argc, char **argv)
+{
+	int repeats = 1000;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+			repeats = std::atoi(argv[++i]);
+		else {
+			std::cerr << "usage: " << argv[0] << " [-n REPEATS]" << std::endl;
+			return 1;
+		}
+	}
+	static const struct {
+		int code_order;
+		const uint32_t *frozen_bits;
+		int first_parity;
+	} codes[] = {
+		{ 10, frozen_1024_562, 3 },
+		{ 11, frozen_2048_1090, 3 },
+		{ 12, frozen_4096_2147, 3 },
+		{ 13, frozen_8192_4261, 5 },
+		{ 14, frozen_16384_8489, 9 },
+	};
+	static CODE::PolarParityEncoder<code_type> nrz_encoder;
+	static CODE::PolarParityPackedEncoder<code_type> packed_encoder;
+	static CODE::CRC<uint32_t> crc(0x8F6E37A0);
+	static uint8_t data[bits_max / 8];
+	static code_type nrz_mesg[bits_max], nrz_code[bits_max], packed_code[bits_max];
+	static uint32_t mesg[bits_max / 32], code_bits[bits_max / 32];
+	std::mt19937 rng(42);
+	bool ok = true;
+	std::cout << std::fixed;
+	for (auto &c : codes) {
+		int data_bits = 1 << (c.code_order - 1);
+		int data_bytes = data_bits / 8;
+		int length = 1 << c.code_order;
+		for (int i = 0; i < data_bytes; ++i)
+			data[i] = rng();
+		crc.reset();
+		for (int i = 0; i < data_bytes; ++i)
+			crc(data[i]);
+		uint32_t sum = crc();
+		auto start = std::chrono::steady_clock::now();
+		for (int r = 0; r < repeats; ++r) {
+			for (int i = 0; i < data_bits; ++i)
+				nrz_mesg[i] = nrz(CODE::get_le_bit(data, i));
+			for (int i = 0; i < 32; ++i)
+				nrz_mesg[i+data_bits] = nrz((sum>>i)&1);
+			nrz_encoder(nrz_code, nrz_mesg, c.frozen_bits, c.code_order, 31, c.first_parity);
+		}
+		std::chrono::duration<double> nrz_time = std::chrono::steady_clock::now() - start;
+		start = std::chrono::steady_clock::now();
+		for (int r = 0; r < repeats; ++r) {
+			for (int i = 0; i < data_bits / 32; ++i)
+				mesg[i] = data[4*i] | data[4*i+1] << 8 | data[4*i+2] << 16 | uint32_t(data[4*i+3]) << 24;
+			mesg[data_bits / 32] = sum;
+			packed_encoder(code_bits, mesg, c.frozen_bits, c.code_order, 31, c.first_parity);
+			packed_encoder.unpack(packed_code, code_bits, c.code_order);
+		}
+		std::chrono::duration<double> packed_time = std::chrono::steady_clock::now() - start;
+		int diff = 0;
+		for (int i = 0; i < length; ++i)
+			diff += nrz_code[i] != packed_code[i];
+		std::cout << "order " << c.code_order << ": nrz " << std::setw(7) << std::setprecision(2) << nrz_time.count() * 1e6 / repeats
+			<< " us, packed " << std::setw(6) << packed_time.count() * 1e6 / repeats << " us, "
+			<< std::setw(5) << std::setprecision(1) << nrz_time.count() / packed_time.count() << " x, "
+			<< diff << " bits differ" << std::endl;
+		ok &= !diff;
+	}
+	std::cout << (ok ? "bit-exact" : "MISMATCH") << std::endl;
+	return !ok;
+}
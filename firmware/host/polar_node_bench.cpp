@@ -0,0 +1,190 @@
+/**
+ * @file polar_node_bench.cpp
+ * @brief Host check and benchmark of the rate-0, rate-1, repetition and SPC nodes of the parity aided polar decoder
+ * 	- bitwise: PolarParityDecoder<..., false>, every node decoded bit by bit, as the decoders did before
+ * 	- special: PolarParityDecoder, the special nodes decoded in one step, fast-SSC for L = 1, fast-SSCL for lists
+ * 	- The same noisy codewords of the codes of order 10 to 14 of the next decoder go through both, at L = 1, 4 and 16.
+ * 	  A frame is decoded when the first lane passing the CRC32 holds the message.
+ * 	  The special nodes must be faster and decode at least as many frames, less 5 % of the frames.
+ * 	  Both decoders take turns REPEAT times, the sum of the best times of each frame is reported.
+ * @note usage: polar_node_bench [-f FRAMES] [-s EBN0_DB] [-r REPEAT]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "simd.hh"
+#include "crc.hh"
+#include "list_crc.hh"
+#include "polar_tables.hh"
+#include "polar_parity_aided.hh"
+
+typedef int8_t code_type;
+
+static const int code_max = 14;
+static const int bits_max = 1 << code_max;
+static const uint32_t poly = 0x8F6E37A0;
+
+struct Code
+{
+	int code_order;
+	const uint32_t *frozen_bits;
+	int first_parity;
+};
+
+struct Frames
+{
+	int count, code_order, data_bits;
+	std::vector<code_type> mesg, code;
+};
+
+struct Result
+{
+	int okay = 0;
+	std::vector<bool> decoded;
+	std::vector<double> seconds;
+	double total() const
+	{
+		double sum = 0;
+		for (double t : seconds)
+			sum += t;
+		return sum;
+	}
+};
+
+static void generate(Frames &frames, const Code &c, int count, float ebn0, std::mt19937 &rng)
+{
+	static CODE::PolarParityEncoder<code_type> encode;
+	static CODE::CRC<uint32_t> crc(poly);
+	int length = 1 << c.code_order;
+	frames.count = count;
+	frames.code_order = c.code_order;
+	frames.data_bits = length / 2;
+	frames.mesg.resize(count * (frames.data_bits + 32));
+	frames.code.resize(count * length);
+	std::normal_distribution<float> awgn;
+	// Noise per code bit for the Eb/N0 per data bit, the LLR is 2y/σ² with half of it as int8_t
+	float sigma = std::sqrt(0.5f / std::pow(10.f, ebn0 / 10.f) * length / frames.data_bits);
+	for (int f = 0; f < count; ++f) {
+		code_type *mesg = frames.mesg.data() + f * (frames.data_bits + 32);
+		code_type *code = frames.code.data() + f * length;
+		crc.reset();
+		for (int i = 0; i < frames.data_bits; ++i) {
+			bool bit = rng() & 1;
+			crc(bit);
+			mesg[i] = 1 - 2 * bit;
+		}
+		uint32_t sum = crc();
+		for (int i = 0; i < 32; ++i)
+			mesg[frames.data_bits + i] = 1 - 2 * ((sum >> i) & 1);
+		encode(code, mesg, c.frozen_bits, c.code_order, 31, c.first_parity);
+		for (int i = 0; i < length; ++i)
+			code[i] = std::min(127.f, std::max(-127.f, std::nearbyint((code[i] + sigma * awgn(rng)) / (sigma * sigma))));
+	}
+}
+
+// Decodes all frames, keeps the best time of each frame over the repeats
+template <typename DECODER, typename TYPE>
+static void decode(Result &result, DECODER &decoder, TYPE *mesg, const Frames &frames, const Code &c)
+{
+	static CODE::ListCRC<uint32_t> crc(poly);
+	int length = 1 << c.code_order;
+	bool first = result.seconds.empty();
+	if (first) {
+		result.okay = 0;
+		result.decoded.assign(frames.count, false);
+		result.seconds.assign(frames.count, 0);
+	}
+	for (int f = 0; f < frames.count; ++f) {
+		const code_type *data = frames.mesg.data() + f * (frames.data_bits + 32);
+		auto start = std::chrono::steady_clock::now();
+		decoder(nullptr, mesg, frames.code.data() + f * length, c.frozen_bits, c.code_order, 31, c.first_parity);
+		int lane = crc(mesg, frames.data_bits + 32);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		if (first || seconds < result.seconds[f])
+			result.seconds[f] = seconds;
+		if (first) {
+			bool okay = lane >= 0;
+			for (int i = 0; okay && i < frames.data_bits; ++i)
+				okay = mesg[i].v[lane] == data[i];
+			result.decoded[f] = okay;
+			result.okay += okay;
+		}
+	}
+}
+
+template <int SIZE>
+static bool bench(const Frames &frames, const Code &c, int repeats)
+{
+	typedef SIMD<code_type, SIZE> mesg_type;
+	auto *bitwise = new CODE::PolarParityDecoder<mesg_type, code_max, false>;
+	auto *special = new CODE::PolarParityDecoder<mesg_type, code_max>;
+	auto *mesg = new mesg_type[bits_max];
+	Result old_result, new_result;
+	for (int r = 0; r < repeats; ++r) {
+		decode(old_result, *bitwise, mesg, frames, c);
+		decode(new_result, *special, mesg, frames, c);
+	}
+	double old_time = old_result.total(), new_time = new_result.total();
+	int differ = 0;
+	for (int f = 0; f < frames.count; ++f)
+		differ += old_result.decoded[f] != new_result.decoded[f];
+	std::cout << "order " << c.code_order << ", list " << std::setw(2) << SIZE
+		<< ": bitwise " << std::setw(8) << std::setprecision(1) << old_time * 1e6 / frames.count
+		<< " us " << std::setw(5) << 100.0 * old_result.okay / frames.count
+		<< " %, special " << std::setw(7) << new_time * 1e6 / frames.count
+		<< " us " << std::setw(5) << 100.0 * new_result.okay / frames.count
+		<< " %, " << std::setw(4) << old_time / new_time << " x, "
+		<< differ << " frames differ" << std::endl;
+	delete bitwise;
+	delete special;
+	delete[] mesg;
+	return new_time < old_time && new_result.okay + frames.count / 20 >= old_result.okay;
+}
+
+int main(int argc, char **argv)
+{
+	int count = 100;
+	float ebn0 = 1.5f;
+	int repeats = 3;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "-f") && i + 1 < argc)
+			count = std::max(1, std::atoi(argv[++i]));
+		else if (!std::strcmp(argv[i], "-s") && i + 1 < argc)
+			ebn0 = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i], "-r") && i + 1 < argc)
+			repeats = std::max(1, std::atoi(argv[++i]));
+		else {
+			std::cerr << "usage: " << argv[0] << " [-f FRAMES] [-s EBN0_DB] [-r REPEAT]" << std::endl;
+			return 1;
+		}
+	}
+	static const Code codes[] = {
+		{ 10, frozen_1024_562, 3 },
+		{ 11, frozen_2048_1090, 3 },
+		{ 12, frozen_4096_2147, 3 },
+		{ 13, frozen_8192_4261, 5 },
+		{ 14, frozen_16384_8489, 9 },
+	};
+	std::mt19937 rng(42);
+	std::cout << count << " frames per code at " << ebn0 << " dB Eb/N0" << std::endl << std::fixed;
+	bool ok = true;
+	for (auto &c : codes) {
+		Frames frames;
+		generate(frames, c, count, ebn0, rng);
+		ok &= bench<1>(frames, c, repeats);
+		ok &= bench<4>(frames, c, repeats);
+		ok &= bench<16>(frames, c, repeats);
+	}
+	std::cout << (ok ? "faster and on par" : "SLOWER OR WORSE") << std::endl;
+	return !ok;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file preamble_bench.cpp
+ * @brief Host check and benchmark of the cached synchronization and metadata symbols of the next encoder
+ * 	- rendered: Encoder::configure() before every packet, so both symbols go through the IFFT and
+ * 	  the PAPR reduction every time, as they did before
+ * 	- cached: configured once, the symbols are rendered for the first packet and replayed after that
+ * 	- Sends PACKETS packets per mode, each behind its own synchronization and metadata symbol.
+ * 	  The time excludes configure().  The audio of both must be identical.
+ * @note usage: preamble_bench [-n PACKETS]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <vector>
+#include "encode.hh"
+
+typedef float value;
+typedef DSP::Complex<value> cmplx;
+
+static const int freq_off = 1600;
+
+static std::vector<int16_t> *sink_audio;
+
+static void sampleSink(int16_t samples[], int count)
+{
+	sink_audio->insert(sink_audio->end(), samples, samples + count);
+}
+
+//! Discards the diagnostic output of the encoder
+struct Quiet
+{
+	struct NullBuffer : std::streambuf
+	{
+		int overflow(int c) override
+		{
+			return c;
+		}
+	} null_buffer;
+	std::streambuf *err;
+	Quiet() : err(std::cerr.rdbuf(&null_buffer))
+	{
+	}
+	~Quiet()
+	{
+		std::cerr.rdbuf(err);
+	}
+};
+
+//! Sends the packets, returns the seconds spent in the synchronization and metadata symbols
+static double encode(std::vector<int16_t> &audio, const modem_config_t *config, const std::vector<uint8_t> &message, int packets, bool cached)
+{
+	auto *encoder = new Encoder<value, cmplx, 8000>();
+	sink_audio = &audio;
+	encoder->setSampleSink(sampleSink);
+	encoder->configure(freq_off, config);
+	int size = encoder->getPacketSize();
+	std::chrono::duration<double> time(0);
+	for (int i = 0; i < packets; ++i) {
+		if (!cached)
+			encoder->configure(freq_off, config);
+		auto start = std::chrono::steady_clock::now();
+		encoder->synchronization_symbol();
+		encoder->metadata_symbol(1);
+		time += std::chrono::steady_clock::now() - start;
+		encoder->data_packet(message.data() + i * size, size);
+	}
+	encoder->silence_packet();
+	sink_audio = nullptr;
+	delete encoder;
+	return time.count();
+}
+
+int main(int argc, char **argv)
+{
+	int packets = 20;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+			packets = std::atoi(argv[++i]);
+		else {
+			std::cerr << "usage: " << argv[0] << " [-n PACKETS]" << std::endl;
+			return 1;
+		}
+	}
+	std::mt19937 rng(42);
+	bool ok = true;
+	std::cout << std::fixed;
+	for (auto &c : modem_configs) {
+		if (!c.code_order)
+			continue;
+		std::vector<uint8_t> message(packets << (c.code_order - 4));
+		for (auto &b : message)
+			b = rng();
+		std::vector<int16_t> rendered_audio, cached_audio;
+		double rendered_time, cached_time;
+		{
+			Quiet quiet;
+			rendered_time = encode(rendered_audio, &c, message, packets, false);
+			cached_time = encode(cached_audio, &c, message, packets, true);
+		}
+		bool same = rendered_audio == cached_audio;
+		std::cout << "mode " << c.oper_mode << ": rendered " << std::setw(7) << std::setprecision(1) << rendered_time * 1e6 / packets
+			<< " us, cached " << std::setw(6) << cached_time * 1e6 / packets << " us per packet, "
+			<< std::setw(5) << rendered_time / cached_time << " x" << (same ? "" : ", audio differs") << std::endl;
+		ok &= same;
+	}
+	std::cout << (ok ? "bit-exact" : "MISMATCH") << std::endl;
+	return !ok;
+}
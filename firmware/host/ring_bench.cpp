@@ -0,0 +1,177 @@
+/**
+ * @file ring_bench.cpp
+ * @brief Host benchmark and check of the sample ring between the I2S reader task and the decoder
+ * 	- SpscRing, wait-free single producer / single consumer ring with bulk read and write
+ * 	- std::queue<int16_t> behind a std::mutex, one sample per push and pop, as I2SAudio did before
+ * 	- A std::thread producer writes blocks of 64 samples like the I2S DMA, the consumer reads blocks of 1440 like the decoder
+ * 	- Checks that no sample is lost or reordered, and that a stalled consumer loses exactly the counted overruns
+ * @note usage: ring_bench [-n SAMPLES]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include "SpscRing.h"
+
+typedef SpscRing<int16_t, 4096> SampleRing;
+
+static const int producer_block = 64;
+static const int consumer_block = 1440;
+
+template <typename FUNC>
+static double seconds(FUNC func)
+{
+	auto start = std::chrono::steady_clock::now();
+	func();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count();
+}
+
+static void report(const char *name, long samples, double time, bool okay)
+{
+	std::cout << std::setw(12) << name << std::setw(10) << std::fixed << std::setprecision(1)
+		<< samples / time * 1e-6 << " MS/s" << (okay ? "  okay" : "  LOST OR REORDERED") << std::endl;
+}
+
+// Producer retries until every block fits, so nothing may get lost
+static bool ring_throughput(long samples)
+{
+	static SampleRing ring;
+	bool okay = true;
+	double time = seconds([&]() {
+		std::thread producer([&]() {
+			int16_t block[producer_block];
+			for (long i = 0; i < samples; i += producer_block) {
+				for (int j = 0; j < producer_block; ++j)
+					block[j] = i + j;
+				while (ring.space() < producer_block)
+					std::this_thread::yield();
+				ring.write(block, producer_block);
+			}
+		});
+		int16_t block[consumer_block];
+		int16_t expected = 0;
+		for (long received = 0; received < samples; ) {
+			size_t n = ring.read(block, consumer_block);
+			if (!n)
+				std::this_thread::yield();
+			for (size_t j = 0; j < n; ++j)
+				okay &= block[j] == expected++;
+			received += n;
+		}
+		producer.join();
+	});
+	report("SpscRing", samples, time, okay && !ring.overruns());
+	return okay && !ring.overruns();
+}
+
+static bool queue_throughput(long samples)
+{
+	std::queue<int16_t> queue;
+	std::mutex mutex;
+	const size_t max_size = 4096;
+	bool okay = true;
+	double time = seconds([&]() {
+		std::thread producer([&]() {
+			for (long i = 0; i < samples; i += producer_block) {
+				for (int j = 0; j < producer_block; ) {
+					std::lock_guard<std::mutex> lock(mutex);
+					if (queue.size() < max_size) {
+						queue.push(i + j);
+						++j;
+					} else {
+						std::this_thread::yield();
+					}
+				}
+			}
+		});
+		int16_t block[consumer_block];
+		int16_t expected = 0;
+		for (long received = 0; received < samples; ) {
+			int n = 0;
+			while (n < consumer_block && received + n < samples) {
+				std::lock_guard<std::mutex> lock(mutex);
+				if (queue.empty()) {
+					std::this_thread::yield();
+					continue;
+				}
+				block[n++] = queue.front();
+				queue.pop();
+			}
+			for (int j = 0; j < n; ++j)
+				okay &= block[j] == expected++;
+			received += n;
+		}
+		producer.join();
+	});
+	report("std::queue", samples, time, okay);
+	return okay;
+}
+
+// Producer never waits, the consumer stalls like a busy decoder
+static bool ring_overrun()
+{
+	// 32 bit counter, so the gaps can be checked without wrap around
+	static SpscRing<int32_t, 4096> ring;
+	const long samples = 1 << 20;
+	long received = 0;
+	bool okay = true;
+	std::thread producer([&]() {
+		int32_t block[producer_block];
+		for (long i = 0; i < samples; i += producer_block) {
+			for (int j = 0; j < producer_block; ++j)
+				block[j] = i + j;
+			ring.write(block, producer_block);
+			if (i % 4096 == 0)
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+		}
+	});
+	int32_t block[consumer_block];
+	int32_t last = -1;
+	for (int stall = 0; producer.joinable(); ++stall) {
+		size_t n = ring.read(block, consumer_block);
+		for (size_t j = 0; j < n; ++j) {
+			// samples may go missing, but never out of order
+			okay &= block[j] > last;
+			last = block[j];
+		}
+		received += n;
+		if (stall % 64 == 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		if (!n && ring.available() == 0 && received + ring.overruns() >= samples)
+			producer.join();
+	}
+	received += ring.read(block, consumer_block);
+	okay &= received + ring.overruns() == samples;
+	std::cout << std::setw(12) << "overrun" << "  received " << received << ", overruns " << ring.overruns()
+		<< (okay ? "  okay" : "  MISCOUNTED") << std::endl;
+	return okay;
+}
+
+int main(int argc, char **argv)
+{
+	long samples = 1 << 24;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+			samples = std::max(1L, std::atol(argv[++i]) / producer_block) * producer_block;
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [-n SAMPLES]" << std::endl;
+			return 1;
+		}
+	}
+	bool okay = true;
+	okay &= ring_throughput(samples);
+	okay &= queue_throughput(samples);
+	okay &= ring_overrun();
+	return !okay;
+}
@@ -0,0 +1,209 @@
+/**
+ * @file sfo_bench.cpp
+ * @brief Host check of the sample rate offset tracking of the next decoder
+ * 	- Encodes PACKETS back to back packets at 8 kHz and resamples them with a windowed sinc,
+ * 	  as if the receiver sampled PPM parts per million faster than the transmitter
+ * 	- Adds white noise at SNR dB, relative to the power of the signal
+ * 	- Decodes with and without Decoder::setSampleRateTracking() and reports the packets decoded,
+ * 	  the estimated offset and the mean Es/N0 of the rows, taken from the diagnostic output
+ * @note usage: sfo_bench [-n PACKETS] [-m MODE] [-s SNR]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "encode.hh"
+#include "decode.hh"
+
+typedef float value;
+typedef DSP::Complex<value> cmplx;
+
+static const int sample_rate = 8000;
+static const int freq_off = 1600;
+static const int block_len = 1440;
+
+static std::vector<int16_t> *sink_audio;
+
+static void sampleSink(int16_t samples[], int count)
+{
+	sink_audio->insert(sink_audio->end(), samples, samples + count);
+}
+
+//! Collects the diagnostic output of the decoder
+struct Capture
+{
+	std::stringstream text;
+	std::streambuf *err;
+	Capture() : err(std::cerr.rdbuf(text.rdbuf()))
+	{
+	}
+	~Capture()
+	{
+		std::cerr.rdbuf(err);
+	}
+};
+
+struct Packets
+{
+	std::vector<double> audio;
+	std::vector<std::vector<uint8_t>> payloads;
+};
+
+static bool encode(Packets &packets, int count, int mode)
+{
+	const modem_config_t *config = nullptr;
+	for (auto &c : modem_configs)
+		if (c.oper_mode == mode && c.code_order)
+			config = &c;
+	auto *encoder = new Encoder<value, cmplx, sample_rate>();
+	std::vector<int16_t> audio;
+	sink_audio = &audio;
+	encoder->setSampleSink(sampleSink);
+	Capture quiet;
+	if (!config || !encoder->configure(freq_off, config)) {
+		delete encoder;
+		return false;
+	}
+	int len = 1 << (config->code_order - 4);
+	std::mt19937 rng(42);
+	encoder->silence_packet();
+	for (int i = 0; i < count; ++i) {
+		std::vector<uint8_t> payload(len);
+		for (auto &b : payload)
+			b = rng();
+		encoder->synchronization_symbol();
+		encoder->metadata_symbol(1);
+		encoder->data_packet(payload.data(), len);
+		encoder->silence_packet();
+		packets.payloads.push_back(payload);
+	}
+	encoder->silence_packet();
+	encoder->silence_packet();
+	sink_audio = nullptr;
+	delete encoder;
+	packets.audio.assign(audio.begin(), audio.end());
+	return true;
+}
+
+//! Band limited resampling, output sample n is taken at the input time n / (1 + ppm / 1e6)
+static std::vector<double> resample(const std::vector<double> &input, double ppm)
+{
+	const int taps = 32;
+	const double pi = 3.14159265358979323846;
+	double step = 1 / (1 + ppm * 1e-6);
+	std::vector<double> output;
+	for (double t = 0; t < input.size(); t += step) {
+		int n = std::floor(t);
+		double sum = 0;
+		for (int k = n - taps / 2 + 1; k <= n + taps / 2; ++k) {
+			if (k < 0 || k >= int(input.size()))
+				continue;
+			double x = t - k;
+			double sinc = x == 0 ? 1 : std::sin(pi * x) / (pi * x);
+			double window = 0.5 + 0.5 * std::cos(pi * x / (taps / 2));
+			sum += input[k] * sinc * window;
+		}
+		output.push_back(sum);
+	}
+	return output;
+}
+
+struct Result
+{
+	int decoded = 0;
+	value sfo = 0;
+	value esn0 = 0;
+};
+
+static Result decode(const Packets &packets, const std::vector<int16_t> &audio, bool tracking)
+{
+	auto *decoder = new Decoder<value, cmplx, sample_rate>();
+	decoder->setSampleRateTracking(tracking);
+	Result result;
+	uint8_t payload[1024];
+	Capture capture;
+	std::vector<int16_t> block(block_len);
+	for (size_t i = 0; i < audio.size() + 16 * block_len; i += block_len) {
+		for (int j = 0; j < block_len; ++j)
+			block[j] = i + j < audio.size() ? audio[i + j] : 0;
+		if (!decoder->feed(block.data(), block_len) || decoder->process() != STATUS_DONE)
+			continue;
+		int len = decoder->fetch(payload);
+		for (auto &p : packets.payloads)
+			if (int(p.size()) == len && std::equal(p.begin(), p.end(), payload))
+				++result.decoded;
+	}
+	result.sfo = decoder->getSampleRateOffset();
+	delete decoder;
+	// The Es/N0 of each row is printed after "Es/N0 (dB):", average over the rows and frames
+	std::string line;
+	int count = 0;
+	double sum = 0;
+	while (std::getline(capture.text, line)) {
+		if (line.compare(0, 11, "Es/N0 (dB):"))
+			continue;
+		std::istringstream row(line.substr(11));
+		double snr;
+		while (row >> snr)
+			sum += snr, ++count;
+	}
+	result.esn0 = count ? sum / count : 0;
+	return result;
+}
+
+int main(int argc, char **argv)
+{
+	int count = 5;
+	int mode = 25;
+	double snr = 30;
+	for (int i = 1; i < argc; ++i) {
+		if (!std::strcmp(argv[i], "-n") && i + 1 < argc)
+			count = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "-m") && i + 1 < argc)
+			mode = std::atoi(argv[++i]);
+		else if (!std::strcmp(argv[i], "-s") && i + 1 < argc)
+			snr = std::atof(argv[++i]);
+		else {
+			std::cerr << "usage: " << argv[0] << " [-n PACKETS] [-m MODE] [-s SNR]" << std::endl;
+			return 1;
+		}
+	}
+	Packets packets;
+	if (!encode(packets, count, mode)) {
+		std::cerr << "unsupported mode " << mode << std::endl;
+		return 1;
+	}
+	double power = 0;
+	int active = 0;
+	for (double x : packets.audio)
+		if (x != 0)
+			power += x * x, ++active;
+	double sigma = std::sqrt(power / active / std::pow(10, snr / 10));
+	std::cout << "mode " << mode << ", " << count << " packets, SNR " << snr << " dB" << std::endl << std::fixed;
+	std::cout << "     ppm   fixed: decoded  Es/N0   tracking: decoded  Es/N0  estimate" << std::endl;
+	bool ok = true;
+	for (double ppm : { 0, 50, 200, 500, 1000, -1000, 2000 }) {
+		std::vector<double> received = resample(packets.audio, ppm);
+		std::mt19937 rng(1);
+		std::normal_distribution<double> awgn(0, sigma);
+		std::vector<int16_t> audio(received.size());
+		for (size_t i = 0; i < received.size(); ++i)
+			audio[i] = std::min<double>(std::max<double>(std::nearbyint(received[i] + awgn(rng)), -32768), 32767);
+		Result fixed = decode(packets, audio, false);
+		Result tracking = decode(packets, audio, true);
+		std::cout << std::setw(8) << std::setprecision(0) << ppm
+			<< std::setw(15) << fixed.decoded << "/" << count << std::setw(7) << std::setprecision(1) << fixed.esn0
+			<< std::setw(18) << tracking.decoded << "/" << count << std::setw(7) << tracking.esn0
+			<< std::setw(10) << tracking.sfo << std::endl;
+		ok &= tracking.decoded >= fixed.decoded;
+	}
+	return !ok;
+}
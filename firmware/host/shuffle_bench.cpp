@@ -0,0 +1,72 @@
+/**
+ * @file shuffle_bench.cpp
+ * @brief Host benchmark of the deinterleavers of the next decoder
+ * 	- CODE::ReverseFisherYatesShuffle, precomputed swap table of SIZE-1 ints
+ * 	- CODE::RewindFisherYatesShuffle, runs the Xorshift32 sequence backwards instead
+ * 	- Checks that both produce the same permutation and reports RAM (including the shared table) and time per call
+ * @note usage: shuffle_bench [-r REPEAT]
+ *
+ * @copyright Copyright (c) 2024
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include "permute.hh"
+
+template <typename FUNC>
+static double per_call(int repeat, FUNC func)
+{
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < repeat; ++i)
+		func();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / repeat;
+}
+
+template <int SIZE>
+static bool bench(int repeat)
+{
+	static CODE::ReverseFisherYatesShuffle<SIZE> table;
+	static CODE::RewindFisherYatesShuffle<SIZE> rewind;
+	static int8_t a[SIZE], b[SIZE];
+	for (int i = 0; i < SIZE; ++i)
+		a[i] = b[i] = i;
+	table(a);
+	rewind(b);
+	bool same = std::equal(a, a + SIZE, b);
+	double table_time = per_call(repeat, [&]() { table(a); });
+	double rewind_time = per_call(repeat, [&]() { rewind(b); });
+	// The swap table is shared, see ReverseFisherYatesShuffle
+	size_t table_bytes = sizeof(table) + (SIZE - 1) * sizeof(int);
+	std::cout << std::setw(6) << SIZE
+		<< "  table " << std::setw(7) << table_bytes << " bytes " << std::setw(8) << std::fixed << std::setprecision(1) << table_time * 1e6 << " us"
+		<< "  rewind " << std::setw(3) << sizeof(rewind) << " bytes " << std::setw(8) << rewind_time * 1e6 << " us"
+		<< (same ? "  same" : "  DIFFERENT") << std::endl;
+	return same;
+}
+
+int main(int argc, char **argv)
+{
+	int repeat = 100;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "-r") && i + 1 < argc)
+			repeat = std::max(1, std::atoi(argv[++i]));
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [-r REPEAT]" << std::endl;
+			return 1;
+		}
+	}
+	bool okay = true;
+	okay &= bench<1024>(repeat);
+	okay &= bench<2048>(repeat);
+	okay &= bench<4096>(repeat);
+	okay &= bench<8192>(repeat);
+	okay &= bench<16384>(repeat);
+	return !okay;
+}
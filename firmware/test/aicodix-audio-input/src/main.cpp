@@ -21,7 +21,7 @@
  */
 
 #include <Arduino.h>
-#include "decode.hh"
+#include "rx_pipeline.hh"
 #include "I2SAudio.h"
 #include "ES8388.h"
 
@@ -32,13 +32,32 @@ static const uint32_t PIN_LED = 22;
 typedef float value;
 typedef DSP::Complex<value> cmplx;
 static const int SAMPLE_RATE = 8000;
-static Decoder<value, cmplx, 8000> *decoder = nullptr;
+// The codec runs at its native rate, the front end decimates to SAMPLE_RATE
+static const int INPUT_RATE = 48000;
+// Front end on core 0, demodulation and FEC in loop() on core 1
+typedef RxPipeline<value, cmplx, SAMPLE_RATE, 16, DefaultSlopeEstimator, INPUT_RATE> Pipeline;
+static Pipeline *pipeline = nullptr;
 static I2SAudio *i2sAudio;
 
-bool sampleSource(int16_t *sample)
+static void frontendTask(void *param)
 {
-	size_t sample_count = 1;
-	return i2sAudio->getSourceSamples(sample, sample_count, I2SAudio::AudioChannel::LEFT);
+	static int16_t block[Pipeline::input_len];
+	int block_fill = 0;
+	int block_len = pipeline->getInputLen();
+	while (true)
+	{
+		size_t sample_count = block_len - block_fill;
+		// Waits for the I2S reader task when the sample ring is empty
+		i2sAudio->getSourceSamples(block + block_fill, sample_count, I2SAudio::AudioChannel::LEFT);
+		block_fill += sample_count;
+		if (block_fill < block_len)
+			continue;
+		block_fill = 0;
+		if (!pipeline->frontend(block, block_len))
+		{
+			ESP_LOGE(TAG, "Block dropped, back end too slow");
+		}
+	}
 }
 
 void setup()
@@ -55,36 +74,54 @@ void setup()
 	audioShield.setOutputVolume(ES8388::OutSel::OUT2, 30);
 	audioShield.mixerSourceControl(DACOUT); // Use LIN and RIN as output
 
-	i2sAudio = new I2SAudio(SAMPLE_RATE, 27, 25, 26, 35);
+	i2sAudio = new I2SAudio(INPUT_RATE, 27, 25, 26, 35);
 	i2sAudio->init();
-	i2sAudio->start_input(16);
+	i2sAudio->start_input();
 
-	int config_index = 4; // operating mode 23
-	decoder = new Decoder<value, cmplx, 8000>();
-	decoder->setSampleSource(sampleSource);
+	pipeline = new Pipeline();
+	xTaskCreatePinnedToCore(frontendTask, "rx front end", 4096, nullptr, 2, nullptr, 0);
 
 	ESP_LOGI(TAG, "Setup complete");
 }
 
 void loop()
 {
-	uint64_t rx_call_sign = 0;
-	uint8_t *dec_msg = nullptr;
-	int len;
-
-	while (decoder->synchronization_symbol())
+	int status = pipeline->backend();
+	if (status < 0)
 	{
-		if (!decoder->metadata_symbol(rx_call_sign))
-		{
-			ESP_LOGE(TAG, "Metadata not detected");
-			return;
-		}
-		ESP_LOGI(TAG, "Metadata: %lu", rx_call_sign);
-		if (decoder->data_packet(&dec_msg, len))
+		// No block queued by the front end
+		vTaskDelay(1);
+		return;
+	}
+	Pipeline::decoder_type *decoder = &pipeline->getDecoder();
+	switch (status)
+	{
+	case STATUS_FAIL:
+	case STATUS_NOPE:
+		// Also when blocks were dropped in the middle of a frame
+		ESP_LOGE(TAG, "Metadata not detected or frame aborted");
+		break;
+	case STATUS_SYNC:
+	{
+		value cfo;
+		int mode;
+		uint64_t rx_call_sign;
+		decoder->staged(&cfo, &mode, &rx_call_sign);
+		ESP_LOGI(TAG, "Metadata: %llu, mode: %d, cfo: %.1f Hz", rx_call_sign, mode, cfo);
+		break;
+	}
+	case STATUS_DONE:
+	{
+		static uint8_t dec_msg[1024];
+		int len = decoder->fetch(dec_msg);
+		if (len > 0)
 		{
 			dec_msg[len - 1] = '\0';
 			ESP_LOGI(TAG, "Message: %s, length: %d", dec_msg, len);
 		}
+		ESP_LOGI(TAG, "Samples lost: %lu, blocks dropped: %lu in %lu gaps, blocks queued: %d", (unsigned long)i2sAudio->getSourceOverruns(I2SAudio::AudioChannel::LEFT),
+				 (unsigned long)pipeline->getOverruns(), (unsigned long)pipeline->getGaps(), pipeline->getBacklog());
+		break;
+	}
 	}
-	ESP_LOGI(TAG, "End of loop");
-}
\ No newline at end of file
+}
@@ -39,7 +39,9 @@ static const uint32_t PIN_LED = 22;
 typedef float value;
 typedef DSP::Complex<value> cmplx;
 static const int SAMPLE_RATE = 8000;
-Encoder<value, cmplx, SAMPLE_RATE> *encoder = nullptr;
+// The symbols are synthesized at SAMPLE_RATE and interpolated to the native rate of the codec
+static const int OUTPUT_RATE = 48000;
+Encoder<value, cmplx, SAMPLE_RATE, OUTPUT_RATE> *encoder = nullptr;
 static I2SAudio *i2sAudio;
 
 /**
@@ -67,12 +69,12 @@ void setup()
     audioShield.setOutputVolume(ES8388::OutSel::OUT2, 30);
     audioShield.mixerSourceControl(DACOUT); // Use LIN and RIN as output
 
-	i2sAudio = new I2SAudio(SAMPLE_RATE, 27, 25, 26, 35);
+	i2sAudio = new I2SAudio(OUTPUT_RATE, 27, 25, 26, 35);
 	i2sAudio->init();
 	i2sAudio->start_output(16);
 
 	int config_index = 4; // operating mode 23
-	encoder = new Encoder<value, cmplx, SAMPLE_RATE>();
+	encoder = new Encoder<value, cmplx, SAMPLE_RATE, OUTPUT_RATE>();
     encoder->configure(1600, &modem_configs[config_index]);
     encoder->setSampleSink(sampleSink);
 
@@ -85,13 +87,8 @@ void sendPacket(const char *msg, int len)
 	// encoder->spectrogram_block(callsign);
 
 	uint64_t call_sign = 0x12345678;
-	int packet_size = encoder->getPacketSize();
-	for (uint8_t *ptr = reinterpret_cast<uint8_t*>(const_cast<char*>(msg)); ptr < reinterpret_cast<uint8_t*>(const_cast<char*>(msg)) + sizeof(msg); ptr += packet_size)
-	{
-		encoder->synchronization_symbol();
-		encoder->metadata_symbol(call_sign);
-		encoder->data_packet(ptr, packet_size);
-	}    
+	// One synchronization and metadata symbol for up to getBurstMax() packets
+	encoder->burst(call_sign, reinterpret_cast<const uint8_t*>(msg), len);
 }
 
 void loop()
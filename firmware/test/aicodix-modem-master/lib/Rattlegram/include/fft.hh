@@ -8,6 +8,7 @@ Copyright 2018 Ahmet Inan <inan@aicodix.de>
 
 #include "unit_circle.hh"
 #include "const.hh"
+#include "shared_table.hh"
 
 namespace DSP {
 namespace FFT {
@@ -1111,17 +1112,24 @@ struct Dit<31, BINS, STRIDE, TYPE, SIGN>
 template <int BINS, typename TYPE, int SIGN>
 class FastFourierTransform
 {
-	TYPE factors[BINS];
 public:
 	typedef typename TYPE::value_type value_type;
-	FastFourierTransform()
-	{
-		for (int n = 0; n < BINS; ++n)
-			factors[n] = TYPE(UnitCircle<value_type>::cos(n, BINS), SIGN * UnitCircle<value_type>::sin(n, BINS));
-	}
+private:
+	// Twiddle factors are immutable and shared by all transforms of the same size and direction
+	struct Factors
+	{
+		TYPE z[BINS];
+		Factors()
+		{
+			for (int n = 0; n < BINS; ++n)
+				z[n] = TYPE(UnitCircle<value_type>::cos(n, BINS), SIGN * UnitCircle<value_type>::sin(n, BINS));
+		}
+	};
+	SharedTable<Factors> factors;
+public:
 	inline void operator ()(TYPE *out, const TYPE *in)
 	{
-		FFT::Dit<FFT::split(BINS), BINS, 1, TYPE, SIGN>::dit(out, in, factors);
+		FFT::Dit<FFT::split(BINS), BINS, 1, TYPE, SIGN>::dit(out, in, factors->z);
 	}
 };
 
@@ -0,0 +1,102 @@
+/*
+Cyclic redundancy check of all the candidates of a list decoder
+
+The list decoder leaves its candidates side by side in the lanes of
+SIMD vectors, one vector per message bit.  Feeding CRC one bit at a
+time walks every lane bit by bit, each step waiting for the last one.
+Here the sign bits are gathered into 64 bit words, which go through
+eight table lookups at once (slice-by-8).  The candidates come sorted
+by their path metric, so the first one is checked alone and passes
+most of the time.  Only if it fails, the words of all the others are
+packed in one pass over the message and their CRCs run side by side.
+Same result as CRC, the same polynomial and bit order.
+*/
+
+#pragma once
+
+#include <cstdint>
+
+namespace CODE {
+
+template <typename TYPE>
+class ListCRC
+{
+	TYPE lut[8][256];
+	TYPE poly;
+	TYPE update(TYPE prev, bool data)
+	{
+		TYPE tmp = prev ^ data;
+		return (prev >> 1) ^ ((tmp & 1) * poly);
+	}
+	TYPE word(TYPE prev, uint64_t data)
+	{
+		data ^= prev;
+		return lut[7][data & 255] ^ lut[6][(data >> 8) & 255] ^
+			lut[5][(data >> 16) & 255] ^ lut[4][(data >> 24) & 255] ^
+			lut[3][(data >> 32) & 255] ^ lut[2][(data >> 40) & 255] ^
+			lut[1][(data >> 48) & 255] ^ lut[0][data >> 56];
+	}
+public:
+	ListCRC(TYPE poly) : poly(poly)
+	{
+		static_assert(sizeof(TYPE) <= sizeof(uint64_t), "CRC wider than the words");
+		for (int j = 0; j < 256; ++j) {
+			TYPE tmp = j;
+			for (int i = 8; i; --i)
+				tmp = update(tmp, 0);
+			lut[0][j] = tmp;
+		}
+		for (int k = 1; k < 8; ++k)
+			for (int j = 0; j < 256; ++j)
+				lut[k][j] = (lut[k-1][j] >> 8) ^ lut[0][lut[k-1][j] & 255];
+	}
+	// CRC of the first bits of a lane, bit i set if mesg[i].v[lane] < 0
+	template <typename MESG>
+	TYPE operator()(const MESG *mesg, int bits, int lane)
+	{
+		TYPE crc = 0;
+		int i = 0;
+		for (; i + 64 <= bits; i += 64) {
+			uint64_t data = 0;
+			for (int j = 0; j < 64; ++j)
+				data |= uint64_t(mesg[i+j].v[lane] < 0) << j;
+			crc = word(crc, data);
+		}
+		for (; i < bits; ++i)
+			crc = update(crc, mesg[i].v[lane] < 0);
+		return crc;
+	}
+	// First lane whose CRC over the first bits is zero, or -1
+	template <typename MESG>
+	int operator()(const MESG *mesg, int bits)
+	{
+		const int SIZE = MESG::SIZE;
+		if ((*this)(mesg, bits, 0) == 0)
+			return 0;
+		if (SIZE == 1)
+			return -1;
+		TYPE crc[SIZE];
+		for (int k = 0; k < SIZE; ++k)
+			crc[k] = 0;
+		int i = 0;
+		for (; i + 64 <= bits; i += 64) {
+			uint64_t data[SIZE];
+			for (int k = 0; k < SIZE; ++k)
+				data[k] = 0;
+			for (int j = 0; j < 64; ++j)
+				for (int k = 0; k < SIZE; ++k)
+					data[k] |= uint64_t(mesg[i+j].v[k] < 0) << j;
+			for (int k = 1; k < SIZE; ++k)
+				crc[k] = word(crc[k], data[k]);
+		}
+		for (; i < bits; ++i)
+			for (int k = 1; k < SIZE; ++k)
+				crc[k] = update(crc[k], mesg[i].v[k] < 0);
+		for (int k = 1; k < SIZE; ++k)
+			if (crc[k] == 0)
+				return k;
+		return -1;
+	}
+};
+
+}
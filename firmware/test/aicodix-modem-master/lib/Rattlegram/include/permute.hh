@@ -7,6 +7,7 @@ Copyright 2023 Ahmet Inan <inan@aicodix.de>
 #pragma once
 
 #include "xorshift.hh"
+#include "shared_table.hh"
 
 namespace CODE {
 
@@ -25,17 +26,23 @@ struct FisherYatesShuffle
 template <int SIZE>
 class ReverseFisherYatesShuffle
 {
-	int seq[SIZE-1];
-public:
-	ReverseFisherYatesShuffle()
+	// The swap sequence is immutable and shared by all instances of the same size
+	struct Sequence
 	{
-		CODE::Xorshift32 prng;
-		for (int i = 0; i < SIZE-1; ++i)
-			seq[i] = i + prng() % (SIZE - i);
-	}
+		int seq[SIZE-1];
+		Sequence()
+		{
+			CODE::Xorshift32 prng;
+			for (int i = 0; i < SIZE-1; ++i)
+				seq[i] = i + prng() % (SIZE - i);
+		}
+	};
+	SharedTable<Sequence> sequence;
+public:
 	template <typename TYPE>
 	void operator()(TYPE *array)
 	{
+		const int *seq = sequence->seq;
 		for (int i = SIZE-2; i >= 0; --i)
 			std::swap(array[i], array[seq[i]]);
 	}
@@ -26,6 +26,7 @@ namespace DSP { using std::abs; using std::min; using std::cos; using std::sin;
 #include "fft.hh"
 #include "mls.hh"
 #include "crc.hh"
+#include "list_crc.hh"
 #include "osd.hh"
 #include "psk.hh"
 #include "qam.hh"
@@ -78,7 +79,7 @@ struct Decoder
 	DSP::TheilSenEstimator<value, cols_max> tse;
 	SchmidlCox<value, cmplx, search_pos, symbol_len/2, guard_len> correlator;
 	CODE::CRC<uint16_t> crc0;
-	CODE::CRC<uint32_t> crc1;
+	CODE::ListCRC<uint32_t> crc1;
 
 	//You should probably play with the OSD ORDER first and set it to two: CODE::OrderedStatisticsDecoder<255, 71, ORDER> osddec;
 	//https://github.com/aicodix/modem/issues/9#issuecomment-1953722270
@@ -466,16 +467,7 @@ struct Decoder
 				code[i] = 0;
 			shuffle(code);
 			polardec(nullptr, mesg, code, frozen_bits, code_order, parity_stride, first_parity);
-			int best = -1;
-			for (int k = 0; k < mesg_type::SIZE; ++k) {
-				crc1.reset();
-				for (int i = 0; i < crc_bits; ++i)
-					crc1(mesg[i].v[k] < 0);
-				if (crc1() == 0) {
-					best = k;
-					break;
-				}
-			}
+			int best = crc1(mesg, crc_bits);
 			if (best < 0) {
 				std::cerr << "payload decoding error." << std::endl;
 				continue;
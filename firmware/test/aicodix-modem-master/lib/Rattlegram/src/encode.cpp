@@ -22,7 +22,7 @@ Copyright 2021 Ahmet Inan <inan@aicodix.de>
 #include "psk.hh"
 #include "qam.hh"
 #include "polar_tables.hh"
-#include "polar_parity_aided.hh"
+#include "polar_parity_packed.hh"
 #include "bose_chaudhuri_hocquenghem_encoder.hh"
 
 template <typename value, typename cmplx, int rate>
@@ -45,12 +45,13 @@ struct Encoder
 	CODE::CRC<uint16_t> crc0;
 	CODE::CRC<uint32_t> crc1;
 	CODE::BoseChaudhuriHocquenghemEncoder<255, 71> bchenc;
-	CODE::PolarParityEncoder<code_type> polarenc;
+	CODE::PolarParityPackedEncoder<code_type> polarenc;
 	CODE::FisherYatesShuffle<4096> shuffle_4096;
 	CODE::FisherYatesShuffle<8192> shuffle_8192;
 	CODE::FisherYatesShuffle<16384> shuffle_16384;
 	uint8_t input_data[data_max];
-	code_type code[bits_max], mesg[bits_max];
+	code_type code[bits_max];
+	uint32_t mesg[bits_max/32], code_bits[bits_max/32];
 	cmplx fdom[symbol_len];
 	cmplx tdom[symbol_len];
 	cmplx temp[symbol_len];
@@ -404,14 +405,14 @@ struct Encoder
 				input_data[i] ^= scrambler();
 			schmidl_cox();
 			meta_data((call_sign << 8) | oper_mode);
-			for (int i = 0; i < data_bits; ++i)
-				mesg[i] = nrz(CODE::get_le_bit(input_data, i));
+			for (int i = 0; i < data_bits / 32; ++i)
+				mesg[i] = input_data[4*i] | input_data[4*i+1] << 8 | input_data[4*i+2] << 16 | uint32_t(input_data[4*i+3]) << 24;
 			crc1.reset();
 			for (int i = 0; i < data_bytes; ++i)
 				crc1(input_data[i]);
-			for (int i = 0; i < 32; ++i)
-				mesg[i+data_bits] = nrz((crc1()>>i)&1);
-			polarenc(code, mesg, frozen_bits, code_order, parity_stride, first_parity);
+			mesg[data_bits / 32] = crc1();
+			polarenc(code_bits, mesg, frozen_bits, code_order, parity_stride, first_parity);
+			polarenc.unpack(code, code_bits, code_order);
 			shuffle(code);
 			for (int i = 0; i < cons_cols; ++i)
 				prev[i] = fdom[bin(i+code_off)];
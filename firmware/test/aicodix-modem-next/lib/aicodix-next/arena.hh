@@ -0,0 +1,60 @@
+/**
+ * @file arena.hh
+ * @brief Fixed size memory arena for buffers, that are only alive during some phases of the decoder
+ * 	- The owner lays out the buffers of every phase at fixed offsets, buffers of different phases may overlap
+ * 	- place() constructs objects at an offset when a phase is entered and records the high-water mark
+ * @note Objects are never destroyed, so only types that are rebuilt on every use belong here.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+static const int arena_alignment = 64;
+
+//! Round up to the alignment of the arena, for laying out the offsets
+constexpr int arena_align(int bytes)
+{
+	return (bytes + arena_alignment - 1) & ~(arena_alignment - 1);
+}
+
+template <int SIZE>
+class Arena
+{
+	alignas(arena_alignment) uint8_t buffer[SIZE];
+	int high_water = 0;
+public:
+	/**
+	 * @brief Construct count objects of TYPE at the given offset
+	 * @return pointer to the first object
+	 */
+	template <typename TYPE>
+	TYPE *place(int offset, int count = 1)
+	{
+		static_assert(alignof(TYPE) <= arena_alignment, "arena alignment too small");
+		int end = offset + count * int(sizeof(TYPE));
+		assert(offset % alignof(TYPE) == 0);
+		assert(end <= SIZE);
+		if (end > high_water)
+			high_water = end;
+		TYPE *ptr = reinterpret_cast<TYPE *>(buffer + offset);
+		for (int i = 0; i < count; ++i)
+			new (ptr + i) TYPE;
+		return ptr;
+	}
+
+	int getSize()
+	{
+		return SIZE;
+	}
+
+	//! Highest byte of the arena used so far
+	int getHighWater()
+	{
+		return high_water;
+	}
+};
@@ -0,0 +1,159 @@
+/*
+Bose Chaudhuri Hocquenghem Decoder
+
+Hard decision decoder for the binary narrow-sense BCH codes of the
+BoseChaudhuriHocquenghemEncoder: the first minimal polynomial spans
+the Galois field and the consecutive roots of the generator polynomial
+set the designed error correction capability.
+The syndromes are computed, the error locator polynomial is found with
+the Berlekamp-Massey algorithm and its roots with the Chien search.
+*/
+
+#pragma once
+
+#include <initializer_list>
+#include "bitman.hh"
+
+namespace CODE {
+
+template <int LEN, int MSG>
+class BoseChaudhuriHocquenghemDecoder
+{
+public:
+	static const int N = LEN, K = MSG, NP = N - K;
+	static const int T = NP / 2;
+private:
+	int16_t exp_[2*N], log_[N+1];
+	int roots;
+	int16_t syndromes[NP], locator[T+1], errors[T];
+	int mul(int a, int b)
+	{
+		return a && b ? exp_[log_[a]+log_[b]] : 0;
+	}
+	// minimal polynomial at $\alpha^i$
+	int eval(int m, int i)
+	{
+		int sum = 0;
+		for (int j = 0; m>>j; ++j)
+			if ((m>>j)&1)
+				sum ^= exp_[(i*j)%N];
+		return sum;
+	}
+public:
+	BoseChaudhuriHocquenghemDecoder(std::initializer_list<int> minimal_polynomials)
+	{
+		int poly = *minimal_polynomials.begin();
+		assert(N < poly && poly <= 2 * N + 1);
+		for (int i = 0, a = 1; i < N; ++i) {
+			exp_[i] = exp_[i+N] = a;
+			log_[a] = i;
+			a <<= 1;
+			if (a > N)
+				a ^= poly;
+		}
+		log_[0] = 0;
+		// $\alpha^1, \alpha^2, \dots, \alpha^{roots}$ are roots of the generator polynomial
+		for (roots = 0; roots < NP; ++roots) {
+			bool root = false;
+			for (auto m: minimal_polynomials)
+				root |= !eval(m, roots+1);
+			if (!root)
+				break;
+		}
+	}
+	int capability()
+	{
+		return roots / 2;
+	}
+	/*
+	Corrects the big endian codeword in place, the first bit being
+	the coefficient of $x^{N-1}$. Returns the number of corrected
+	errors or -1, if there are more than the code can correct.
+	*/
+	int operator()(uint8_t *code)
+	{
+		// $S_i = code(\alpha^i)$
+		for (int i = 0; i < roots; ++i)
+			syndromes[i] = 0;
+		for (int j = 0; j < N; ++j) {
+			if (!get_be_bit(code, j))
+				continue;
+			int pos = N - 1 - j;
+			for (int i = 0, idx = pos; i < roots; i += 2) {
+				syndromes[i] ^= exp_[idx];
+				idx += 2 * pos;
+				if (idx >= N)
+					idx %= N;
+			}
+		}
+		// $S_{2i} = S_i^2$ for binary codes
+		for (int i = 1; i < roots; i += 2)
+			syndromes[i] = mul(syndromes[i/2], syndromes[i/2]);
+		int nonzero = 0;
+		for (int i = 0; i < roots; ++i)
+			nonzero |= syndromes[i];
+		if (!nonzero)
+			return 0;
+		// Berlekamp-Massey
+		int16_t prev[T+1], temp[T+1];
+		int degree = 0, shift = 1, last = 1;
+		for (int i = 0; i <= T; ++i)
+			locator[i] = prev[i] = 0;
+		locator[0] = prev[0] = 1;
+		for (int n = 0; n < roots; ++n) {
+			int discrepancy = syndromes[n];
+			for (int i = 1; i <= degree; ++i)
+				discrepancy ^= mul(locator[i], syndromes[n-i]);
+			if (!discrepancy) {
+				++shift;
+				continue;
+			}
+			int coef = mul(discrepancy, exp_[N-log_[last]]);
+			if (2 * degree <= n) {
+				for (int i = 0; i <= T; ++i)
+					temp[i] = locator[i];
+				for (int i = shift; i <= T; ++i)
+					locator[i] ^= mul(coef, prev[i-shift]);
+				degree = n + 1 - degree;
+				if (degree > capability())
+					return -1;
+				for (int i = 0; i <= T; ++i)
+					prev[i] = temp[i];
+				last = discrepancy;
+				shift = 1;
+			} else {
+				for (int i = shift; i <= T; ++i)
+					locator[i] ^= mul(coef, prev[i-shift]);
+				++shift;
+			}
+		}
+		// Chien search: $locator(\alpha^{-pos}) = 0$ for every error position
+		int16_t terms[T+1];
+		for (int i = 1; i <= degree; ++i)
+			terms[i] = locator[i] ? log_[locator[i]] : -1;
+		int count = 0;
+		for (int pos = 0; pos < N; ++pos) {
+			int sum = locator[0];
+			for (int i = 1; i <= degree; ++i) {
+				if (terms[i] < 0)
+					continue;
+				sum ^= exp_[terms[i]];
+				terms[i] -= i;
+				if (terms[i] < 0)
+					terms[i] += N;
+			}
+			if (!sum) {
+				if (count == degree)
+					return -1;
+				errors[count++] = pos;
+			}
+		}
+		if (count != degree)
+			return -1;
+		for (int i = 0; i < count; ++i)
+			xor_be_bit(code, N - 1 - errors[i], 1);
+		return count;
+	}
+};
+
+}
@@ -0,0 +1,84 @@
+/*
+Polyphase FIR decimator
+
+Low pass filter at the Nyquist frequency of the output rate, made of
+the LowPass2 kernel and a Kaiser window.  Only every FACTOR-th output
+of the filter is computed, that is the polyphase decomposition with
+the commutator folded into the sample history.
+With FACTOR 6, a codec at 48 kHz can feed an 8 kHz decoder.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include "filter.hh"
+#include "window.hh"
+
+namespace DSP {
+
+template <typename TYPE, int FACTOR, int TAPS>
+class Decimator
+{
+	static_assert(TAPS % FACTOR == 0, "TAPS not divisible by FACTOR");
+	TYPE coef[TAPS];
+	TYPE hist[2*TAPS];
+	int pos = 0, phase = 0;
+public:
+	Decimator(TYPE a = TYPE(2))
+	{
+		LowPass2<TYPE> filter(1, 2 * FACTOR);
+		Kaiser<TYPE> window(a);
+		TYPE sum = 0;
+		for (int i = 0; i < TAPS; ++i)
+			sum += coef[i] = filter(i, TAPS) * window(i, TAPS);
+		for (int i = 0; i < TAPS; ++i)
+			coef[i] /= sum;
+		for (int i = 0; i < 2*TAPS; ++i)
+			hist[i] = 0;
+	}
+	// Returns true, when an output sample is ready
+	bool operator()(TYPE *output, TYPE input)
+	{
+		hist[pos] = hist[pos+TAPS] = input;
+		if (++pos == TAPS)
+			pos = 0;
+		if (++phase < FACTOR)
+			return false;
+		phase = 0;
+		// hist[pos] is the oldest sample
+		const TYPE *x = hist + pos;
+		TYPE sum = 0;
+		for (int i = 0; i < TAPS; ++i)
+			sum += coef[i] * x[i];
+		*output = sum;
+		return true;
+	}
+	// Returns the number of output samples, at most (count + FACTOR - 1) / FACTOR
+	int operator()(int16_t *output, const int16_t *input, int count)
+	{
+		int num = 0;
+		for (int i = 0; i < count; ++i) {
+			TYPE out;
+			if ((*this)(&out, TYPE(input[i]))) {
+				out = out < TYPE(-32768) ? TYPE(-32768) : out > TYPE(32767) ? TYPE(32767) : out;
+				output[num++] = std::nearbyint(out);
+			}
+		}
+		return num;
+	}
+	const TYPE *coefficients()
+	{
+		return coef;
+	}
+	static constexpr int factor()
+	{
+		return FACTOR;
+	}
+	static constexpr int taps()
+	{
+		return TAPS;
+	}
+};
+
+}
@@ -9,102 +9,225 @@
  * @copyright Copyright (c) 2024
  * @note Based on the [original code](https://github.com/aicodix/modem/tree/next) from Ahmet Inan <inan@aicodix.de>, Copyright 2021
 */
+#pragma once
 
 #include <iostream>
 #include <cassert>
 #include <cstdint>
 #include <cmath>
 namespace DSP { using std::abs; using std::min; using std::cos; using std::sin; }
-#include "schmidl_cox.hh"
-#include "bip_buffer.hh"
 #include "theil_sen.hh"
+#include "repeated_median.hh"
 #include "xorshift.hh"
 #include "complex.hh"
 #include "permute.hh"
 #include "decibel.hh"
-#include "blockdc.hh"
-#include "hilbert.hh"
 #include "phasor.hh"
 #include "bitman.hh"
 #include "delay.hh"
+#include "farrow.hh"
 #include "wav.hh"
 #include "pcm.hh"
 #include "fft.hh"
 #include "mls.hh"
 #include "crc.hh"
+#include "list_crc.hh"
+#include "arena.hh"
+#include "shared_table.hh"
+#include "bose_chaudhuri_hocquenghem_decoder.hh"
 #include "osd.hh"
 #include "psk.hh"
 #include "qam.hh"
+#include "modulation.hh"
 #include "polar_tables.hh"
 #include "polar_parity_aided.hh"
 #include "modem_config.hh"
+#include "profile.hh"
+#include "synchronizer.hh"
 
+#define STATUS_OKAY 0
+#define STATUS_FAIL 1
+#define STATUS_SYNC 2
+#define STATUS_DONE 3
+#define STATUS_HEAP 4
+#define STATUS_NOPE 5
+#define STATUS_PING 6
 
-template <typename value, typename cmplx, int rate>
+#if defined(ESP32) && !defined(BOARD_HAS_PSRAM)
+// Without PSRAM, the Theil-Sen estimator does not fit into the internal SRAM
+template <typename TYPE, int LEN_MAX>
+using DefaultSlopeEstimator = DSP::RepeatedMedianEstimator<TYPE, LEN_MAX>;
+#else
+template <typename TYPE, int LEN_MAX>
+using DefaultSlopeEstimator = DSP::TheilSenEstimator<TYPE, LEN_MAX>;
+#endif
+
+/**
+ * @brief OFDM decoder
+ * @tparam SlopeEstimator robust line fit for the phase correction, DSP::TheilSenEstimator needs
+ * 	O(cols_max²) memory (166 KB), DSP::RepeatedMedianEstimator only O(cols_max)
+ * @tparam input_rate rate of the samples passed to feed(), a multiple of rate, e.g. 48000 for the codec.
+ * 	The Synchronizer decimates them to rate, so the FFTs and buffers keep their size.
+ * @note The buffers of the preamble, demodulation and FEC phases share an Arena.  Without PSRAM
+ * 	on the ESP32, the polar decoder only uses successive cancellation, which brings the decoder
+ * 	down to about 280 KB, without the tables shared by all instances.
+ */
+template <typename value, typename cmplx, int rate, template <typename, int> class SlopeEstimator = DefaultSlopeEstimator, int input_rate = rate>
 struct Decoder
 {
 private:
 	typedef int8_t code_type;
 #ifdef __AVX2__
 	typedef SIMD<code_type, 32 / sizeof(code_type)> mesg_type;
+#elif defined(ESP32) && !defined(BOARD_HAS_PSRAM)
+	// Only successive cancellation fits into the internal SRAM
+	typedef SIMD<code_type, 1> mesg_type;
 #elif defined(ESP32)
 	typedef SIMD<code_type, 8 / sizeof(code_type)> mesg_type;
 #else
 	typedef SIMD<code_type, 16 / sizeof(code_type)> mesg_type;
+#endif
+	// Narrower lists tried first, see fetch()
+	typedef SIMD<code_type, 1> mesg1_type;
+	typedef SIMD<code_type, 4> mesg4_type;
+	static const int list_steps = mesg_type::SIZE > 1 ? 3 : 1;
+	// Order 3 of the preamble OSD gains about 1 dB, but costs a few ms on noise
+#ifdef ESP32
+	static const int osd_order = 2;
+#else
+	static const int osd_order = 3;
 #endif
 	typedef DSP::Const<value> Const;
-	static const int symbol_len = (1280 * rate) / 8000;
-	static const int filter_len = (((21 * rate) / 8000) & ~3) | 1;
-	static const int guard_len = symbol_len / 8;
-	static const int extended_len = symbol_len + guard_len;
+	typedef Synchronizer<value, cmplx, rate, input_rate> sync_type;
+	typedef Modulation<cmplx, code_type> modulation_type;
+	static const int symbol_len = sync_type::symbol_len;
+	static const int guard_len = sync_type::guard_len;
+	static const int extended_len = sync_type::extended_len;
 	static const int code_max = 14;
 	static const int bits_max = 1 << code_max;
 	static const int data_max = 1024;
 	static const int cols_max = 273 + 16;
 	static const int rows_max = 32;
-	static const int cons_max = cols_max * rows_max;
-	static const int mls0_len = 127;
-	static const int mls0_off = - mls0_len + 1;
-	static const int mls0_poly = 0b10001001;
+	static const int mls0_poly = sync_type::mls0_poly;
 	static const int mls1_len = 255;
 	static const int mls1_off = - mls1_len / 2;
 	static const int mls1_poly = 0b100101011;
-	static const int buffer_len = 4 * extended_len;
-	static const int search_pos = extended_len;
+	// Rows needed for a fit of the timing within a frame
+	static const int sfo_rows = 4;
+	static constexpr value sfo_max = 0.002;
+	// Samples needed for a symbol stretched by sfo_max, plus the taps of the interpolator
+	static const int resample_len = symbol_len + symbol_len / 256 + 4;
 	DSP::ReadPCM<value> *pcm;
 	DSP::FastFourierTransform<symbol_len, cmplx, -1> fwd;
-	DSP::BlockDC<value, value> blockdc;
-	DSP::Hilbert<cmplx, filter_len> hilbert;
-	DSP::BipBuffer<cmplx, buffer_len> input_hist;
-	DSP::TheilSenEstimator<value, cols_max> tse;
-	SchmidlCox<value, cmplx, search_pos, symbol_len/2, guard_len> correlator;
+	typedef SlopeEstimator<value, cols_max> tse_type;
+	typedef CODE::PackedOrderedStatisticsDecoder<255, 71, osd_order> osd_type;
+	template <typename TYPE>
+	using polar_type = CODE::PolarParityDecoder<TYPE, code_max>;
+	/*
+	Arena layout, buffers of different phases overlap:
+	preamble:	[ code  | osd    ...  | cons ]	code may still wait for fetch()
+	demodulate:	[ code  | tse    ...  | cons ]	every row goes to code as soon as it is demodulated
+	fetch:		[ code  | polar | mesg ... ]	one list size at a time
+	*/
+	static const int code_bytes = arena_align(bits_max * sizeof(code_type));
+	static const int cons_bytes = arena_align(cols_max * sizeof(cmplx));
+	static const int osd_off = code_bytes;
+	static const int tse_off = code_bytes;
+	static const int fec_off = code_bytes;
+	template <typename TYPE>
+	static constexpr int fec_bytes()
+	{
+		return arena_align(sizeof(polar_type<TYPE>)) + bits_max * sizeof(TYPE);
+	}
+	static const int fec_max = list_steps > 1 ? std::max(fec_bytes<mesg1_type>(), std::max(fec_bytes<mesg4_type>(), fec_bytes<mesg_type>())) : fec_bytes<mesg1_type>();
+	static const int arena_size = arena_align(std::max(std::max(osd_off + arena_align(sizeof(osd_type)), tse_off + arena_align(sizeof(tse_type))) + cons_bytes, fec_off + fec_max));
+	static const int cons_off = arena_size - cons_bytes;
 	CODE::CRC<uint16_t> crc0;
-	CODE::CRC<uint32_t> crc1;
-	CODE::OrderedStatisticsDecoder<255, 71, 2/*4*/> osddec;
-	CODE::PolarParityDecoder<mesg_type, code_max> polardec;
-	CODE::ReverseFisherYatesShuffle<1024> shuffle_1024;
-	CODE::ReverseFisherYatesShuffle<2048> shuffle_2048;
-	CODE::ReverseFisherYatesShuffle<4096> shuffle_4096;
-	CODE::ReverseFisherYatesShuffle<8192> shuffle_8192;
-	CODE::ReverseFisherYatesShuffle<16384> shuffle_16384;
-	uint8_t output_data[data_max];
-	int8_t genmat[255*71];
-	mesg_type mesg[bits_max];
-	code_type code[bits_max];
-	cmplx cons[cons_max], prev[cols_max];
+	CODE::ListCRC<uint32_t> crc1;
+	CODE::BoseChaudhuriHocquenghemDecoder<255, 71> bchdec;
+	CODE::RewindFisherYatesShuffle<1024> shuffle_1024;
+	CODE::RewindFisherYatesShuffle<2048> shuffle_2048;
+	CODE::RewindFisherYatesShuffle<4096> shuffle_4096;
+	CODE::RewindFisherYatesShuffle<8192> shuffle_8192;
+	CODE::RewindFisherYatesShuffle<16384> shuffle_16384;
+	// The BCH generator matrix is immutable and shared by all decoders
+	struct GeneratorMatrix
+	{
+		int8_t genmat[255*71];
+		GeneratorMatrix()
+		{
+			CODE::BoseChaudhuriHocquenghemGenerator<255, 71>::matrix(genmat, true, {
+				0b100011101, 0b101110111, 0b111110011, 0b101101001,
+				0b110111101, 0b111100111, 0b100101011, 0b111010111,
+				0b000010011, 0b101100101, 0b110001011, 0b101100011,
+				0b100011011, 0b100111111, 0b110001101, 0b100101101,
+				0b101011111, 0b111111001, 0b111000011, 0b100111001,
+				0b110101001, 0b000011111, 0b110000111, 0b110110001});
+		}
+	};
+	SharedTable<GeneratorMatrix> genmat;
+	Arena<arena_size> arena;
+	tse_type *tse;
+	osd_type *osddec;
+	code_type *code;
+	cmplx *cons;
+	cmplx prev[cols_max];
+	// Hard decisions of the current row, mapped back onto the constellation
+	cmplx hard[cols_max];
+	// Kernels of the modulation of the current frame
+	const modulation_type *modulation = nullptr;
 	cmplx fdom[symbol_len], tdom[symbol_len];
 	value index[cols_max], phase[cols_max];
-	value cfo_rad, sfo_rad;
+	// Sample rate offset, carried over from frame to frame
+	value sfo = 0;
+	// Position of the current symbol relative to its nominal position, in samples
+	value timing = 0;
+	// Sum of the timing differences between the symbols, measured by the phase slopes
+	value residual = 0;
+	// Timing of the last rows, over all code blocks of a burst
+	value row_index[rows_max+1], row_timing[rows_max+1];
+	int row_count = 0;
+	SlopeEstimator<value, rows_max+1> row_tse;
+	DSP::Farrow<cmplx, value> farrow;
+	cmplx base[resample_len];
+	bool sfo_tracking = true;
+	// Es/N0 over all rows of the last code block, in dB
+	value esn0 = 0;
+	// Signal and noise power of the rows of the current code block so far, and their Es/N0 in dB
+	value sig_pwr = 0, noise_pwr = 0;
+	value row_esn0[rows_max];
+	value staged_cfo_rad = 0;
+	uint64_t staged_call = 0;
+	int staged_position = 0;
+	int staged_mode = 0;
+	int staged_blocks = 1;
+	bool staged_check = false;
 	int mod_bits;
 	int code_order;
-	int symbol_pos;
-	int oper_mode;
+	int oper_mode = 0;
+	int cons_rows = 0;
+	int cons_cols;
+	int comb_cols;
+	int code_cols;
+	int comb_dist;
+	int comb_off;
+	int code_off;
+	int symbol_number = 0;
+	// Code blocks behind the metadata symbol of a burst
+	int burst_blocks = 1;
+	int block_number = 0;
+	int symbol_position;
 	int crc_bits;
+	bool adaptive_list = true;
+	int list_okay[list_steps] = {0};
+	int list_fail = 0;
 	const cmplx *buf;
-	bool (*sampleSource)(int16_t* sample) { nullptr }; 
 	DSP::Phasor<cmplx> osc;
+	CODE::MLS seq0;
 	uint8_t preamble_bits[(mls1_len+7)/8];
 	int reserved_tones;
+	Profile profile;
+	sync_type sync;
 
 
 	static int bin(int carrier)
@@ -124,78 +247,34 @@ private:
 			return 0;
 		return cons;
 	}
-	const cmplx *mls0_seq()
-	{
-		CODE::MLS seq0(mls0_poly);
-		for (int i = 0; i < symbol_len/2; ++i)
-			fdom[i] = 0;
-		for (int i = 0; i < mls0_len; ++i)
-			fdom[(i+mls0_off/2+symbol_len/2)%(symbol_len/2)] = nrz(seq0());
-		return fdom;
-	}
-	cmplx mod_map(code_type *b)
-	{
-		switch (mod_bits) {
-		case 2:
-			return PhaseShiftKeying<4, cmplx, code_type>::map(b);
-		case 3:
-			return PhaseShiftKeying<8, cmplx, code_type>::map(b);
-		case 4:
-			return QuadratureAmplitudeModulation<16, cmplx, code_type>::map(b);
-		case 6:
-			return QuadratureAmplitudeModulation<64, cmplx, code_type>::map(b);
-		}
-		return 0;
-	}
-	void mod_hard(code_type *b, cmplx c)
-	{
-		switch (mod_bits) {
-		case 2:
-			return PhaseShiftKeying<4, cmplx, code_type>::hard(b, c);
-		case 3:
-			return PhaseShiftKeying<8, cmplx, code_type>::hard(b, c);
-		case 4:
-			return QuadratureAmplitudeModulation<16, cmplx, code_type>::hard(b, c);
-		case 6:
-			return QuadratureAmplitudeModulation<64, cmplx, code_type>::hard(b, c);
-		}
-	}
-	void mod_soft(code_type *b, cmplx c, value precision)
-	{
-		switch (mod_bits) {
-		case 2:
-			return PhaseShiftKeying<4, cmplx, code_type>::soft(b, c, precision);
-		case 3:
-			return PhaseShiftKeying<8, cmplx, code_type>::soft(b, c, precision);
-		case 4:
-			return QuadratureAmplitudeModulation<16, cmplx, code_type>::soft(b, c, precision);
-		case 6:
-			return QuadratureAmplitudeModulation<64, cmplx, code_type>::soft(b, c, precision);
-		}
-	}
 
-	const cmplx *next_sample()
+	void stage(const typename sync_type::Detection &detection)
 	{
-		cmplx tmp;
-		int16_t sample;
-		sampleSource(&sample);
-		tmp = hilbert(blockdc(sample));
-		return input_hist(tmp);
+		buf = sync.buffer();
+		if (detection.check) {
+			staged_cfo_rad = detection.cfo_rad;
+			staged_position = detection.position;
+			staged_check = true;
+		}
 	}
 
-	bool preamble()
+	/**
+	 * @brief Decode the metadata symbol at the staged position
+	 * @return STATUS_OKAY when a payload follows, STATUS_PING for mode 0,
+	 * 	STATUS_NOPE for an unsupported mode or call sign and STATUS_FAIL on decoding errors
+	 */
+	int preamble()
 	{
-		osc.omega(-cfo_rad);
-		// Fill buffer with samples
+		PROFILE_SCOPE(profile, PREAMBLE);
+		DSP::Phasor<cmplx> nco;
+		nco.omega(-staged_cfo_rad);
 		for (int i = 0; i < symbol_len; ++i)
-			tdom[i] = buf[i+symbol_pos+extended_len] * osc();
-		// Preamble has been read, remove it from the buffer
-		for (int i = 0; i < symbol_pos+extended_len; ++i)
+			tdom[i] = buf[i+staged_position] * nco();
+		// Forward FFT
 		{
-			correlator(buf = next_sample());
+			PROFILE_SCOPE(profile, FFT);
+			fwd(fdom, tdom);
 		}
-		// Forward FFT
-		fwd(fdom, tdom);
 		// Ordered Statistics Decoder
 		CODE::MLS seq1(mls1_poly);
 		for (int i = 0; i < mls1_len; ++i)
@@ -206,285 +285,644 @@ private:
 				std::nearbyint(127 * demod_or_erase(
 				fdom[bin(i+mls1_off)], fdom[bin(i-1+mls1_off)]).real()),
 				-127), 127);
-		bool unique = osddec(preamble_bits, soft, genmat);
+		// Try the hard decisions with the algebraic decoder first
+		for (int i = 0; i < mls1_len; ++i)
+			CODE::set_be_bit(preamble_bits, i, soft[i] < 0);
+		bool unique;
+		{
+			PROFILE_SCOPE(profile, BCH);
+			unique = bchdec(preamble_bits) >= 0;
+		}
+		if (!unique) {
+			PROFILE_SCOPE(profile, OSD);
+			osddec = arena.template place<osd_type>(osd_off);
+			unique = (*osddec)(preamble_bits, soft, genmat->genmat);
+		}
 		if (!unique) {
 			std::cerr << "OSD error." << std::endl;
-			return false;
+			profile.count(Profile::PREAMBLE_FAIL);
+			return STATUS_FAIL;
 		}
-		return true;
+		uint64_t meta_data = 0;
+		for (int i = 0; i < 55; ++i)
+			meta_data |= (uint64_t)CODE::get_be_bit(preamble_bits, i) << i;
+		uint16_t checksum = 0;
+		for (int i = 0; i < 16; ++i)
+			checksum |= (uint16_t)CODE::get_be_bit(preamble_bits, i+55) << i;
+		crc0.reset();
+		if (crc0(meta_data<<9) != checksum) {
+			std::cerr << "header CRC error." << std::endl;
+			profile.count(Profile::PREAMBLE_FAIL);
+			return STATUS_FAIL;
+		}
+		// The upper three bits of the mode byte carry the number of code blocks of a burst
+		staged_mode = meta_data & 31;
+		staged_blocks = ((meta_data >> 5) & 7) + 1;
+		staged_call = meta_data >> 8;
+		std::cerr << "oper mode: " << staged_mode << std::endl;
+		if (staged_blocks > 1)
+			std::cerr << "burst of " << staged_blocks << " blocks" << std::endl;
+		if (!find_modem_config(staged_mode)) {
+			std::cerr << "operation mode " << staged_mode << " unsupported." << std::endl;
+			return STATUS_NOPE;
+		}
+		if (staged_call == 0 || staged_call >= 129961739795077L) {
+			std::cerr << "call sign unsupported." << std::endl;
+			staged_call = 0;
+			return STATUS_NOPE;
+		}
+		if (!staged_mode)
+			return STATUS_PING;
+		return STATUS_OKAY;
 	}
 
-	bool demodulate()
+	/**
+	 * @brief Prepare the reception of the payload symbols for the staged mode
+	 */
+	void start()
 	{
-		if (!oper_mode)
-			return false;
-		int cons_rows, comb_cols, code_cols;
-		for(int i=0; i<sizeof(modem_configs)/sizeof(modem_configs[0]); i++)
-		{
-			if(modem_configs[i].oper_mode == oper_mode)
-			{
-				mod_bits = modem_configs[i].mod_bits;
-				cons_rows = modem_configs[i].cons_rows;
-				comb_cols = modem_configs[i].comb_cols;
-				code_order = modem_configs[i].code_order;
-				code_cols = modem_configs[i].code_cols;
-				reserved_tones = modem_configs[i].reserved_tones;
-				break;
-			}
-		}
-		int cons_cols = code_cols + comb_cols;
-		int comb_dist = comb_cols ? cons_cols / comb_cols : 1;
-		int comb_off = comb_cols ? comb_dist / 2 : 1;
-		int code_off = - cons_cols / 2;
-
+		const modem_config_t *config = find_modem_config(staged_mode);
+		oper_mode = staged_mode;
+		mod_bits = config->mod_bits;
+		modulation = modulation_type::select(mod_bits);
+		cons_rows = config->cons_rows;
+		comb_cols = config->comb_cols;
+		code_order = config->code_order;
+		code_cols = config->code_cols;
+		reserved_tones = config->reserved_tones;
+		cons_cols = code_cols + comb_cols;
+		comb_dist = comb_cols ? cons_cols / comb_cols : 1;
+		comb_off = comb_cols ? comb_dist / 2 : 1;
+		code_off = - cons_cols / 2;
+		osc.omega(-staged_cfo_rad);
+		symbol_position = staged_position;
+		symbol_number = -1;
+		burst_blocks = staged_blocks;
+		block_number = 0;
+		timing = 0;
+		residual = 0;
+		row_index[0] = -1;
+		row_timing[0] = 0;
+		row_count = 1;
+		seq0 = CODE::MLS(mls0_poly);
 		std::cerr << "modulation bits: " << mod_bits << std::endl;
-		for (int i = 0; i < symbol_len; ++i)
-			tdom[i] = buf[i] * osc();
-		for (int i = 0; i < guard_len; ++i)
-			osc();
-		fwd(fdom, tdom);
-		for (int i = 0; i < cons_cols; ++i)
-			prev[i] = fdom[bin(i+code_off)];
 		std::cerr << "demod " << cons_rows << " rows" << std::endl;
-		CODE::MLS seq0(mls0_poly);
-		for (int j = 0; j < cons_rows; ++j) {
-			// Skip guard interval
-			for (int i = 0; i < extended_len; ++i)
-			{
-				correlator(buf = next_sample());
+	}
+
+	/**
+	 * @brief Demodulate the symbol in the current block
+	 * @note The metadata symbol (symbol_number < 0) only serves as phase reference.
+	 */
+	void demodulate()
+	{
+		PROFILE_SCOPE(profile, DEMODULATE);
+		tse = arena.template place<tse_type>(tse_off);
+		if (sfo_tracking && symbol_number >= 0) {
+			// Follow the drift with the fit over the rows once there are enough of them,
+			// before that from the timing of the previous symbol and the offset of the last frame
+			value scale = 1 + sfo;
+			if (row_count >= sfo_rows) {
+				timing = row_tse(block_number * cons_rows + symbol_number);
+				scale = 1 + std::min(std::max(row_tse.slope() / extended_len, -sfo_max), sfo_max);
+			} else {
+				timing = row_timing[row_count-1] + extended_len * sfo;
 			}
+			resample(timing, scale);
+		} else {
 			for (int i = 0; i < symbol_len; ++i)
-				tdom[i] = buf[i] * osc();
-			for (int i = 0; i < guard_len; ++i)
-				osc();
+				tdom[i] = buf[i+symbol_position] * osc();
+		}
+		for (int i = 0; i < guard_len; ++i)
+			osc();
+		{
+			PROFILE_SCOPE(profile, FFT);
 			fwd(fdom, tdom);
+		}
+		if (symbol_number < 0) {
 			for (int i = 0; i < cons_cols; ++i)
-				cons[cons_cols*j+i] = demod_or_erase(fdom[bin(i+code_off)], prev[i]);
-			if (/*oper_mode>25*/ reserved_tones) {
-				for (int i = 0; i < comb_cols; ++i)
-					cons[cons_cols*j+comb_dist*i+comb_off] *= nrz(seq0());
-				for (int i = 0; i < comb_cols; ++i) {
-					index[i] = code_off + comb_dist * i + comb_off;
-					phase[i] = arg(cons[cons_cols*j+comb_dist*i+comb_off]);
-				}
-				tse.compute(index, phase, comb_cols);
-				//std::cerr << "Theil-Sen slope = " << tse.slope() << std::endl;
-				//std::cerr << "Theil-Sen yint = " << tse.yint() << std::endl;
-				for (int i = 0; i < cons_cols; ++i)
-					cons[cons_cols*j+i] *= DSP::polar<value>(1, -tse(i+code_off));
-				for (int i = 0; i < cons_cols; ++i)
-					if (i % comb_dist == comb_off)
-						prev[i] = fdom[bin(i+code_off)];
-					else
-						prev[i] *= DSP::polar<value>(1, tse(i+code_off));
+				prev[i] = fdom[bin(i+code_off)];
+			return;
+		}
+		// Phase slope over the carriers, caused by the timing difference to the previous symbol
+		value drift = 0;
+		for (int i = 0; i < cons_cols; ++i)
+			cons[i] = demod_or_erase(fdom[bin(i+code_off)], prev[i]);
+		if (/*oper_mode>25*/ reserved_tones) {
+			for (int i = 0; i < comb_cols; ++i)
+				cons[comb_dist*i+comb_off] *= nrz(seq0());
+			for (int i = 0; i < comb_cols; ++i) {
+				index[i] = code_off + comb_dist * i + comb_off;
+				phase[i] = arg(cons[comb_dist*i+comb_off]);
 			}
-			for (int i = 0; i < cons_cols; ++i) {
-				index[i] = code_off + i;
-				if (i % comb_dist == comb_off) {
-					phase[i] = arg(cons[cons_cols*j+i]);
-				} else {
-					code_type tmp[mod_bits];
-					mod_hard(tmp, cons[cons_cols*j+i]);
-					phase[i] = arg(cons[cons_cols*j+i] * conj(mod_map(tmp)));
-				}
+			{
+				PROFILE_SCOPE(profile, THEIL_SEN);
+				tse->compute(index, phase, comb_cols);
 			}
-			tse.compute(index, phase, cons_cols);
+			drift = tse->slope();
 			//std::cerr << "Theil-Sen slope = " << tse.slope() << std::endl;
 			//std::cerr << "Theil-Sen yint = " << tse.yint() << std::endl;
 			for (int i = 0; i < cons_cols; ++i)
-				cons[cons_cols*j+i] *= DSP::polar<value>(1, -tse(i+code_off));
-			if (reserved_tones/*oper_mode>25*/) {
-				for (int i = 0; i < cons_cols; ++i)
-					if (i % comb_dist != comb_off)
-						prev[i] *= DSP::polar<value>(1, tse(i+code_off));
-			} else {
-				for (int i = 0; i < cons_cols; ++i)
-					prev[i] = fdom[bin(i+code_off)];
+				cons[i] *= DSP::polar<value>(1, -(*tse)(i+code_off));
+			for (int i = 0; i < cons_cols; ++i)
+				prev[i] *= DSP::polar<value>(1, (*tse)(i+code_off));
+			for (int i = comb_off; i < cons_cols; i += comb_dist)
+				prev[i] = fdom[bin(i+code_off)];
+		}
+		// The pilots are their own reference
+		modulation->hard(hard, cons, cons_cols);
+		if (reserved_tones)
+			for (int i = comb_off; i < cons_cols; i += comb_dist)
+				hard[i] = 1;
+		for (int i = 0; i < cons_cols; ++i) {
+			index[i] = code_off + i;
+			phase[i] = arg(cons[i] * conj(hard[i]));
+		}
+		{
+			PROFILE_SCOPE(profile, THEIL_SEN);
+			tse->compute(index, phase, cons_cols);
+		}
+		if (!reserved_tones)
+			drift = tse->slope();
+		//std::cerr << "Theil-Sen slope = " << tse.slope() << std::endl;
+		//std::cerr << "Theil-Sen yint = " << tse.yint() << std::endl;
+		for (int i = 0; i < cons_cols; ++i)
+			cons[i] *= DSP::polar<value>(1, -(*tse)(i+code_off));
+		if (sfo_tracking)
+			track(drift);
+		if (reserved_tones/*oper_mode>25*/) {
+			for (int i = 0; i < cons_cols; ++i)
+				prev[i] *= DSP::polar<value>(1, (*tse)(i+code_off));
+			for (int i = comb_off; i < cons_cols; i += comb_dist)
+				prev[i] = fdom[bin(i+code_off)];
+		} else {
+			for (int i = 0; i < cons_cols; ++i)
+				prev[i] = fdom[bin(i+code_off)];
+		}
+		std::cerr << ".";
+	}
+
+	/**
+	 * @brief Take the samples of the current symbol at timing + i * scale, mixed down to baseband
+	 * @note The cubic interpolation only works at baseband, so a stretch of the buffer is mixed down first.
+	 * 	The phase of the mixer stays the one of osc() at the nominal positions.
+	 */
+	void resample(value timing, value scale)
+	{
+		int shift = std::floor(timing);
+		shift = std::min(std::max(symbol_position + shift, 1), sync_type::buffer_len - resample_len) - symbol_position;
+		// Only off by more than a sample, when the shift hit the end of the buffer
+		value delay = std::min(std::max(timing - shift, value(0)), value(1));
+		const cmplx *x = buf + symbol_position + shift - 1;
+		cmplx turn = osc() * DSP::polar<value>(1, -staged_cfo_rad * (shift - 1));
+		for (int i = 1; i < symbol_len; ++i)
+			osc();
+		DSP::Phasor<cmplx> nco;
+		nco.omega(-staged_cfo_rad);
+		for (int i = 0; i < resample_len; ++i)
+			base[i] = x[i] * nco() * turn;
+		for (int i = 0; i < symbol_len; ++i) {
+			value t = delay + i * scale;
+			int n = t;
+			farrow.mu(t - n);
+			tdom[i] = farrow(base + 1 + n);
+		}
+	}
+
+	/**
+	 * @brief Fit a line to the timing of the last rows, the slope is the sample rate offset
+	 * @param drift phase slope in radians per carrier of the current symbol against the previous one
+	 * @note Long bursts are fitted over a sliding window of rows_max rows.
+	 */
+	void track(value drift)
+	{
+		// A delay by d samples turns the phase by -2 pi d / symbol_len per carrier
+		residual -= drift * symbol_len / Const::TwoPi();
+		if (row_count == rows_max + 1) {
+			for (int i = 1; i < row_count; ++i) {
+				row_index[i-1] = row_index[i];
+				row_timing[i-1] = row_timing[i];
 			}
-			std::cerr << ".";
+			--row_count;
 		}
-		std::cerr << " done" << std::endl;
-		std::cerr << "Es/N0 (dB):";
-		value sp = 0, np = 0;
-		for (int j = 0, k = 0; j < cons_rows; ++j) {
-			if (reserved_tones/*oper_mode>25*/) {
-				for (int i = 0; i < comb_cols; ++i) {
-					cmplx hard(1, 0);
-					cmplx error = cons[cons_cols*j+comb_dist*i+comb_off] - hard;
-					sp += norm(hard);
-					np += norm(error);
-				}
-			} else {
-				for (int i = 0; i < cons_cols; ++i) {
-					code_type tmp[mod_bits];
-					mod_hard(tmp, cons[cons_cols*j+i]);
-					cmplx hard = mod_map(tmp);
-					cmplx error = cons[cons_cols*j+i] - hard;
-					sp += norm(hard);
-					np += norm(error);
-				}
+		row_index[row_count] = block_number * cons_rows + symbol_number;
+		row_timing[row_count] = timing + residual;
+		++row_count;
+		bool last = symbol_number == cons_rows - 1;
+		// Short frames only give an estimate for the next frame
+		if (row_count < sfo_rows && !(last && row_count >= 3))
+			return;
+		row_tse.compute(row_index, row_timing, row_count);
+		if (last)
+			sfo = std::min(std::max(row_tse.slope() / extended_len, -sfo_max), sfo_max);
+	}
+
+	/**
+	 * @brief Update the estimate of Es/N0 and convert the constellation points of the current row to soft bits
+	 * @note The precision of the soft bits is the Es/N0 over the rows of the code block so far,
+	 * 	so the soft bits are ready when the last row of the block is in.
+	 */
+	void demap()
+	{
+		PROFILE_SCOPE(profile, DEMAP);
+		int j = symbol_number;
+		if (!j)
+			sig_pwr = noise_pwr = 0;
+		if (reserved_tones/*oper_mode>25*/) {
+			for (int i = 0; i < comb_cols; ++i) {
+				cmplx hard(1, 0);
+				cmplx error = cons[comb_dist*i+comb_off] - hard;
+				sig_pwr += norm(hard);
+				noise_pwr += norm(error);
 			}
-			value precision = sp / np;
-			// precision = 8;
-			value snr = DSP::decibel(precision);
-			std::cerr << " " << snr;
-			if (std::is_same<code_type, int8_t>::value && precision > 32)
-				precision = 32;
+		} else {
+			modulation->hard(hard, cons, cons_cols);
 			for (int i = 0; i < cons_cols; ++i) {
-				if (reserved_tones/*oper_mode>25*/  && i % comb_dist == comb_off)
+				cmplx error = cons[i] - hard[i];
+				sig_pwr += norm(hard[i]);
+				noise_pwr += norm(error);
+			}
+		}
+		value precision = sig_pwr / noise_pwr;
+		// precision = 8;
+		row_esn0[j] = DSP::decibel(precision);
+		if (std::is_same<code_type, int8_t>::value && precision > 32)
+			precision = 32;
+		int k = j * code_cols * mod_bits;
+		if (reserved_tones/*oper_mode>25*/) {
+			// The pilots split the row into runs of data carriers
+			for (int i = 0; i < cons_cols;) {
+				if (i % comb_dist == comb_off) {
+					++i;
 					continue;
-				mod_soft(code+k, cons[cons_cols*j+i], precision);
-				k += mod_bits;
+				}
+				int pilot = i + (comb_off - i % comb_dist + comb_dist) % comb_dist;
+				int count = std::min(pilot, cons_cols) - i;
+				k += modulation->soft(code+k, cons+i, count, precision);
+				i += count;
 			}
+		} else {
+			modulation->soft(code+k, cons, cons_cols, precision);
 		}
+	}
+
+	//! After the last row of a code block
+	void finish()
+	{
+		std::cerr << " done" << std::endl;
+		std::cerr << "Es/N0 (dB):";
+		for (int j = 0; j < cons_rows; ++j)
+			std::cerr << " " << row_esn0[j];
 		std::cerr << std::endl;
+		esn0 = DSP::decibel(sig_pwr / noise_pwr);
+		if (sfo_tracking)
+			std::cerr << "sfo: " << sfo * 1000000 << " ppm" << std::endl;
 		for (int i = code_cols * cons_rows * mod_bits; i < bits_max; ++i)
 			code[i] = 0;
-		return true;
-	}	
+	}
+
+	/**
+	 * @brief Polar list decoding followed by the CRC32 check of every list candidate
+	 * @return index of the first candidate passing the CRC, or -1
+	 */
+	template <typename TYPE>
+	int polar(CODE::PolarParityDecoder<TYPE, code_max> &decoder, TYPE *message, const uint32_t *frozen_bits, int parity_stride, int first_parity)
+	{
+		{
+			PROFILE_SCOPE(profile, POLAR);
+			decoder(nullptr, message, code, frozen_bits, code_order, parity_stride, first_parity);
+		}
+		PROFILE_SCOPE(profile, CRC);
+		// Be careful, a packet of all zeros will pass the CRC check
+		return crc1(message, crc_bits);
+	}
+	/**
+	 * @brief Decode with the list size of TYPE, the decoder and its messages take the place of the constellation
+	 * @return index of the candidate passing the CRC, or -1
+	 */
+	template <typename TYPE>
+	int list(uint8_t *payload, const uint32_t *frozen_bits, int parity_stride, int first_parity, int data_bits)
+	{
+		polar_type<TYPE> *decoder = arena.template place<polar_type<TYPE>>(fec_off);
+		TYPE *message = arena.template place<TYPE>(fec_off + arena_align(sizeof(polar_type<TYPE>)), bits_max);
+		int best = polar(*decoder, message, frozen_bits, parity_stride, first_parity);
+		if (best >= 0)
+			unpack(payload, message, best, data_bits);
+		return best;
+	}
+	template <typename TYPE>
+	static void unpack(uint8_t *payload, const TYPE *message, int lane, int data_bits)
+	{
+		for (int i = 0; i < data_bits; ++i)
+			CODE::set_le_bit(payload, i, message[i].v[lane] < 0);
+	}
 
 
 public:
-	Decoder() : correlator(mls0_seq()), crc0(0xA8F4), crc1(0x8F6E37A0)
-	{
-		CODE::BoseChaudhuriHocquenghemGenerator<255, 71>::matrix(genmat, true, {
+	Decoder() : crc0(0xA8F4), crc1(0x8F6E37A0), bchdec({
 			0b100011101, 0b101110111, 0b111110011, 0b101101001,
 			0b110111101, 0b111100111, 0b100101011, 0b111010111,
 			0b000010011, 0b101100101, 0b110001011, 0b101100011,
 			0b100011011, 0b100111111, 0b110001101, 0b100101101,
 			0b101011111, 0b111111001, 0b111000011, 0b100111001,
-			0b110101001, 0b000011111, 0b110000111, 0b110110001});
-		blockdc.samples(filter_len);
+			0b110101001, 0b000011111, 0b110000111, 0b110110001}),
+		seq0(mls0_poly), sync(profile)
+	{
+		code = arena.template place<code_type>(0, bits_max);
+		cons = arena.template place<cmplx>(cons_off, cols_max);
 
 		// Print memory usage of decoder
-		std::cerr << "Decoder memory usage: " << sizeof(*this) << " bytes" << std::endl;
+		std::cerr << "Decoder memory usage: " << sizeof(*this) << " bytes, arena: " << arena_size << " bytes, shared tables: " << SharedTables::bytes() << " bytes" << std::endl;
 	}
 
-	bool synchronization_symbol()
+	/**
+	 * @brief Feed audio samples to the decoder
+	 * 	The samples go through the DC blocker, Hilbert filter and Schmidl-Cox correlator.
+	 * @param samples mono 16-bit audio samples at input_rate
+	 * @param count number of samples, at most getInputLen()
+	 * @return true when a block of getExtendedLen() samples is complete, call process() then
+	 * @note Feed blocks of exactly getInputLen() samples, so the block boundaries and the processing stay aligned.
+	 */
+	bool feed(const int16_t *samples, int count)
 	{
-		do {
-			buf = next_sample();
-			if(!buf)
-				return false;
-		} while (!correlator(buf));
-
-		symbol_pos = correlator.symbol_pos;
-		cfo_rad = correlator.cfo_rad;
-		std::cerr << "symbol pos: " << symbol_pos << std::endl;
-		std::cerr << "coarse cfo: " << cfo_rad * (rate / Const::TwoPi()) << " Hz " << std::endl;
+		if (!sync(samples, count))
+			return false;
+		stage(sync.detection());
 		return true;
 	}
 
-	bool metadata_symbol(uint64_t& call_sign)
+	/**
+	 * @brief Feed audio samples, that another Synchronizer already searched for the synchronization symbol
+	 * 	Only the DC blocker and the Hilbert filter run here, see RxPipeline.
+	 * @param detection result of the other Synchronizer for the block completed by these samples
+	 * @note The other Synchronizer must be fed the same samples in the same blocks.  If it decimates, these are
+	 * 	its samples() at rate, fed to a Decoder without input_rate.
+	 */
+	bool feed(const int16_t *samples, int count, const typename sync_type::Detection &detection)
 	{
-		if(!preamble())
+		if (!sync(samples, count, false))
 			return false;
+		stage(sync.settled() ? detection : sync.detection());
+		return true;
+	}
 
-		uint64_t meta_data = 0;
-		for (int i = 0; i < 55; ++i)
-			meta_data |= (uint64_t)CODE::get_be_bit(preamble_bits, i) << i;
-		uint16_t checksum = 0;
-		for (int i = 0; i < 16; ++i)
-			checksum |= (uint16_t)CODE::get_be_bit(preamble_bits, i+55) << i;
-		crc0.reset();
-		if (crc0(meta_data<<9) != checksum) {
-			std::cerr << "header CRC error." << std::endl;
-			return false;
-		}
-		oper_mode = meta_data & 255;
-		if (oper_mode)
-		{
-			bool found=false;
-			for(int i=0; i<sizeof(modem_configs)/sizeof(modem_configs[0]); i++)
-			{
-				if(modem_configs[i].oper_mode == oper_mode)
-				{
-					found=true;
-					break;
-				}
-			}
-			if(!found)
-			{
-				std::cerr << "operation mode " << oper_mode << " unsupported." << std::endl;
-				return false;
+	/**
+	 * @brief Start over after a gap in the samples, e.g. a block dropped by the RxPipeline
+	 * 	The frame in progress is aborted, and detections are ignored until the sample history
+	 * 	is refilled with samples from after the gap.
+	 * @return true when a frame was in progress
+	 */
+	bool reset()
+	{
+		bool aborted = staged_check || symbol_number < cons_rows || block_number + 1 < burst_blocks;
+		if (aborted)
+			std::cerr << "frame aborted, gap in the samples" << std::endl;
+		sync.reset();
+		staged_check = false;
+		symbol_number = cons_rows;
+		block_number = 0;
+		burst_blocks = 1;
+		return aborted;
+	}
+
+	/**
+	 * @brief Process the block completed by feed()
+	 * @return STATUS_SYNC when the metadata of a packet with payload has been decoded,
+	 * 	STATUS_DONE when all payload symbols of a code block have been received and fetch() can be called,
+	 * 	once for every code block of a burst,
+	 * 	STATUS_PING, STATUS_NOPE or STATUS_FAIL for packets without (usable) payload,
+	 * 	STATUS_OKAY otherwise
+	 */
+	int process()
+	{
+		int status = STATUS_OKAY;
+		if (staged_check) {
+			staged_check = false;
+			std::cerr << "symbol pos: " << staged_position << std::endl;
+			std::cerr << "coarse cfo: " << staged_cfo_rad * (rate / Const::TwoPi()) << " Hz " << std::endl;
+			status = preamble();
+			if (status == STATUS_OKAY) {
+				start();
+				status = STATUS_SYNC;
 			}
 		}
-		std::cerr << "oper mode: " << oper_mode << std::endl;
-		if ((meta_data>>8) == 0 || (meta_data>>8) >= 129961739795077L) {
-			std::cerr << "call sign unsupported." << std::endl;
-			return false;
+		if (symbol_number == cons_rows && block_number + 1 < burst_blocks) {
+			// Next code block of the burst, the phase references carry on from the last symbol
+			++block_number;
+			symbol_number = 0;
+			seq0 = CODE::MLS(mls0_poly);
+			std::cerr << "block " << block_number + 1 << " of " << burst_blocks << std::endl;
 		}
-		call_sign = meta_data >> 8;
-
-		return true;
+		if (symbol_number < cons_rows) {
+			demodulate();
+			if (symbol_number >= 0)
+				demap();
+			if (++symbol_number == cons_rows) {
+				finish();
+				status = STATUS_DONE;
+			}
+		}
+		return status;
 	}
 
-
-	bool data_packet(uint8_t** msg, int& len)
+	/**
+	 * @brief Metadata of the last detected packet
+	 * @param cfo carrier frequency offset in Hz
+	 * @param mode operating mode
+	 * @param call_sign base37 encoded call sign
+	 */
+	void staged(value *cfo, int *mode, uint64_t *call_sign)
 	{
-		if(!demodulate())
-			return false;
+		*cfo = staged_cfo_rad * (rate / Const::TwoPi());
+		*mode = staged_mode;
+		*call_sign = staged_call;
+	}
 
+	/**
+	 * @brief Decode the payload, right after process() returned STATUS_DONE
+	 * @note The next process() may reuse the soft bits for the following packet, see Arena
+	 * @param payload receives up to 1024 bytes
+	 * @return number of payload bytes, or -1 on decoding errors
+	 */
+	int fetch(uint8_t *payload)
+	{
+		if (!oper_mode || symbol_number != cons_rows)
+			return -1;
 		int data_bits = 1 << (code_order -1);
 		std::cerr << "data bits: " << data_bits << std::endl;
 		crc_bits = data_bits + 32;
 
-		switch(code_order) {
-		case 10:
-			// 64 bytes
-			shuffle_1024(code);
-			polardec(nullptr, mesg, code, frozen_1024_562, code_order, 31, 3);
-			break;
-		case 11:
-			// 128 bytes
-			shuffle_2048(code);
-			polardec(nullptr, mesg, code, frozen_2048_1090, code_order, 31, 3);
-			break;
-		case 12:
-			// 256 bytes
-			shuffle_4096(code);
-			polardec(nullptr, mesg, code, frozen_4096_2147, code_order, 31, 3);
-			break;
-		case 13:
-			// 512 bytes
-			shuffle_8192(code);
-			polardec(nullptr, mesg, code, frozen_8192_4261, code_order, 31, 5);
-			break;
-		case 14:
-			// 1024 bytes
-			shuffle_16384(code);
-			polardec(nullptr, mesg, code, frozen_16384_8489, code_order, 31, 9);
-			break;
+		const uint32_t *frozen_bits = nullptr;
+		int parity_stride = 31;
+		int first_parity = 0;
+		{
+			PROFILE_SCOPE(profile, SHUFFLE);
+			switch(code_order) {
+			case 10:
+				// 64 bytes
+				shuffle_1024(code);
+				frozen_bits = frozen_1024_562;
+				first_parity = 3;
+				break;
+			case 11:
+				// 128 bytes
+				shuffle_2048(code);
+				frozen_bits = frozen_2048_1090;
+				first_parity = 3;
+				break;
+			case 12:
+				// 256 bytes
+				shuffle_4096(code);
+				frozen_bits = frozen_4096_2147;
+				first_parity = 3;
+				break;
+			case 13:
+				// 512 bytes
+				shuffle_8192(code);
+				frozen_bits = frozen_8192_4261;
+				first_parity = 5;
+				break;
+			case 14:
+				// 1024 bytes
+				shuffle_16384(code);
+				frozen_bits = frozen_16384_8489;
+				first_parity = 9;
+				break;
+			}
 		}
-		int best = -1;
-		for (int k = 0; k < mesg_type::SIZE; ++k) {
-			crc1.reset();
-			for (int i = 0; i < crc_bits; ++i)
-				crc1(mesg[i].v[k] < 0);
-			if (crc1() == 0) {
-				// Be careful, a packet of all zeros will pass the CRC check
-				best = k;
+		// Successive cancellation and a small list are enough for most packets,
+		// the full list is only needed when their CRC check fails
+		int best = -1, step = adaptive_list ? 0 : list_steps - 1;
+		for (; best < 0 && step < list_steps; ++step) {
+			switch (step) {
+			case 0:
+				best = list<mesg1_type>(payload, frozen_bits, parity_stride, first_parity, data_bits);
+				break;
+			case 1:
+				best = list<mesg4_type>(payload, frozen_bits, parity_stride, first_parity, data_bits);
 				break;
+			default:
+				best = list<mesg_type>(payload, frozen_bits, parity_stride, first_parity, data_bits);
 			}
 		}
 		if (best < 0) {
 			std::cerr << "payload decoding error." << std::endl;
-			return false;
+			++list_fail;
+			profile.count(Profile::PAYLOAD_FAIL);
+			return -1;
 		}
-		for (int i = 0; i < data_bits; ++i)
-			CODE::set_le_bit(output_data, i, mesg[i].v[best] < 0);
+		std::cerr << "list size: " << getListSize(step-1) << std::endl;
+		++list_okay[step-1];
+		profile.count(Profile::PAYLOAD_OKAY);
 		CODE::Xorshift32 scrambler;
 		int data_bytes = data_bits / 8;
 		for (int i = 0; i < data_bytes; ++i)
-			output_data[i] ^= scrambler();
-		*msg = output_data;
-		len = data_bytes;
-		return true;
+			payload[i] ^= scrambler();
+		return data_bytes;
+	}
+
+	int getExtendedLen()
+	{
+		return extended_len;
 	}
 
-	void setSampleSource(bool (*source)(int16_t* sample))
+	//! Samples at input_rate per block
+	int getInputLen()
 	{
-		sampleSource = source;
+		return sync_type::input_len;
 	}
 
+	/**
+	 * @brief Es/N0 of the last code block in dB, valid once process() returned STATUS_DONE
+	 * @note Measured on the pilots in the modes with reserved tones, otherwise against the hard decisions,
+	 * 	which reads high when the constellation points are no longer separated.
+	 */
+	value getEsN0()
+	{
+		return esn0;
+	}
+
+	//! Number of code blocks of the current burst, 1 for single packets
+	int getBurstBlocks()
+	{
+		return burst_blocks;
+	}
+
+	//! Index of the code block of the current burst, that the last STATUS_DONE was for
+	int getBlockNumber()
+	{
+		return block_number;
+	}
+
+	/**
+	 * @brief Try successive cancellation and a list size of 4 before the full list
+	 * @param enable false always decodes with the full list size
+	 */
+	void setAdaptiveList(bool enable)
+	{
+		adaptive_list = enable;
+	}
+
+	/**
+	 * @brief Track the sample rate offset between transmitter and receiver
+	 * @param enable false demodulates every symbol at its nominal position
+	 * @note The offset is estimated from the phase slopes over the rows of a frame and corrected
+	 * 	with a fractional delay, the estimate of the last frame is the starting point of the next.
+	 */
+	void setSampleRateTracking(bool enable)
+	{
+		sfo_tracking = enable;
+		if (!enable)
+			sfo = 0;
+	}
+
+	//! Estimated sample rate offset of the last frame in ppm, positive when the receiver samples faster
+	value getSampleRateOffset()
+	{
+		return sfo * 1000000;
+	}
+
+	//! Number of list sizes tried by the adaptive polar decoding
+	int getListSteps()
+	{
+		return list_steps;
+	}
+
+	//! List size of the given step: 1, 4 and the full SIMD width
+	int getListSize(int step)
+	{
+		return step == 0 ? mesg1_type::SIZE : step == 1 ? mesg4_type::SIZE : mesg_type::SIZE;
+	}
+
+	//! Number of payloads decoded successfully with the list size of the given step
+	int getListOkay(int step)
+	{
+		return list_okay[step];
+	}
+
+	//! Number of payloads that failed with all list sizes
+	int getListFail()
+	{
+		return list_fail;
+	}
+
+	//! Size of the memory arena shared by the preamble, demodulation and FEC phases
+	int getArenaSize()
+	{
+		return arena.getSize();
+	}
+
+	//! Highest byte of the arena used so far
+	int getArenaHighWater()
+	{
+		return arena.getHighWater();
+	}
+
+	/**
+	 * @brief Per-stage timing and event counters
+	 * @note Only filled in when built with MODEM_PROFILE, use dump() to print them as JSON.
+	 */
+	Profile &getProfile()
+	{
+		return profile;
+	}
 };
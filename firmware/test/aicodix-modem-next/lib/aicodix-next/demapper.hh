@@ -0,0 +1,115 @@
+/*
+Soft demapping of a whole row of constellation points
+
+The soft() functions of PhaseShiftKeying and QuadratureAmplitudeModulation
+quantize one bit at a time: scale, std::nearbyint and the clamp to the
+int8_t range.  Here the modulation is chosen and the scale is computed
+once per row.  The rounding adds and subtracts 1.5 * 2^23, which rounds
+to nearest even like std::nearbyint in the default rounding mode.  It is
+only exact below 2^22, but larger values end up beyond the clamp anyway.
+Without branches and library calls, the loops vectorize and the soft
+bits are bit-exact with soft().
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include "psk.hh"
+#include "qam.hh"
+
+template <typename cmplx, typename code_type>
+class SoftDemapper
+{
+	typedef typename cmplx::value_type value;
+	typedef PhaseShiftKeying<4, cmplx, code_type> psk4_type;
+	typedef PhaseShiftKeying<8, cmplx, code_type> psk8_type;
+	typedef QuadratureAmplitudeModulation<16, cmplx, code_type> qam16_type;
+	typedef QuadratureAmplitudeModulation<64, cmplx, code_type> qam64_type;
+	static constexpr bool saturate = std::is_same<code_type, int8_t>::value;
+
+	static code_type quantize(value scale, value x)
+	{
+		x *= scale;
+		if (saturate) {
+			const value magic = std::is_same<value, float>::value ? value(12582912) : value(6755399441055744.0);
+			x += magic;
+			x -= magic;
+			x = std::min<value>(std::max<value>(x, -127), 127);
+		} else if (std::is_integral<code_type>::value) {
+			x = std::nearbyint(x);
+		}
+		return x;
+	}
+
+public:
+	// Soft bits of count points, same as soft() of the modulation on each, return the number of soft bits
+	static int psk4(code_type *b, const cmplx *c, int count, value precision)
+	{
+		value scale = psk4_type::DIST * precision;
+		for (int i = 0; i < count; ++i) {
+			b[2*i+0] = quantize(scale, c[i].real());
+			b[2*i+1] = quantize(scale, c[i].imag());
+		}
+		return psk4_type::BITS * count;
+	}
+
+	static int psk8(code_type *b, const cmplx *c, int count, value precision)
+	{
+		value scale = psk8_type::DIST * precision;
+		for (int i = 0; i < count; ++i) {
+			b[3*i+1] = quantize(scale, c[i].real());
+			b[3*i+2] = quantize(scale, c[i].imag());
+			b[3*i+0] = quantize(scale, psk8_type::rcp_sqrt_2 * (std::abs(c[i].real()) - std::abs(c[i].imag())));
+		}
+		return psk8_type::BITS * count;
+	}
+
+	static int qam16(code_type *b, const cmplx *c, int count, value precision)
+	{
+		value scale = qam16_type::DIST * precision;
+		for (int i = 0; i < count; ++i) {
+			b[4*i+0] = quantize(scale, c[i].real());
+			b[4*i+1] = quantize(scale, c[i].imag());
+			b[4*i+2] = quantize(scale, std::abs(c[i].real())-qam16_type::amp(2));
+			b[4*i+3] = quantize(scale, std::abs(c[i].imag())-qam16_type::amp(2));
+		}
+		return qam16_type::BITS * count;
+	}
+
+	static int qam64(code_type *b, const cmplx *c, int count, value precision)
+	{
+		value scale = qam64_type::DIST * precision;
+		for (int i = 0; i < count; ++i) {
+			b[6*i+0] = quantize(scale, c[i].real());
+			b[6*i+1] = quantize(scale, c[i].imag());
+			b[6*i+2] = quantize(scale, std::abs(c[i].real())-qam64_type::amp(4));
+			b[6*i+3] = quantize(scale, std::abs(c[i].imag())-qam64_type::amp(4));
+			b[6*i+4] = quantize(scale, std::abs(std::abs(c[i].real())-qam64_type::amp(4))-qam64_type::amp(2));
+			b[6*i+5] = quantize(scale, std::abs(std::abs(c[i].imag())-qam64_type::amp(4))-qam64_type::amp(2));
+		}
+		return qam64_type::BITS * count;
+	}
+
+	/**
+	 * @brief Soft bits of count constellation points, same as soft() of the modulation on each point
+	 * @param bits bits per point: 2, 3, 4 or 6
+	 * @return number of soft bits written
+	 */
+	static int row(int bits, code_type *b, const cmplx *c, int count, value precision)
+	{
+		switch (bits) {
+		case 2:
+			return psk4(b, c, count, precision);
+		case 3:
+			return psk8(b, c, count, precision);
+		case 4:
+			return qam16(b, c, count, precision);
+		case 6:
+			return qam64(b, c, count, precision);
+		}
+		return 0;
+	}
+};
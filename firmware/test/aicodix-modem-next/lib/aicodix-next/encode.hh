@@ -12,7 +12,9 @@
 #include <cassert>
 #include <cstdint>
 #include <cstring>
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 #include "xorshift.hh"
 #include "complex.hh"
 #include "permute.hh"
@@ -26,19 +28,32 @@
 #include "crc.hh"
 #include "psk.hh"
 #include "qam.hh"
+#include "modulation.hh"
 #include "polar_tables.hh"
-#include "polar_parity_aided.hh"
+#include "polar_parity_packed.hh"
 #include "bose_chaudhuri_hocquenghem_encoder.hh"
 #include "modem_config.hh"
+#include "interpolator.hh"
 
-template <typename value, typename cmplx, int rate>
+/**
+ * @tparam rate the symbols are synthesized at this rate, 8000 keeps the FFTs small
+ * @tparam output_rate rate of the samples passed to the sample sink, e.g. 16000, 44100 or 48000 for the codec.
+ * 	The interpolator runs in the write-out loop of symbol(), it costs 16 multiply-adds per output sample.
+ */
+template <typename value, typename cmplx, int rate, int output_rate = rate>
 struct Encoder
 {
+	// The filter of the interpolator spans 16 samples at the synthesis rate
+	typedef DSP::Interpolator<value, output_rate / std::gcd(rate, output_rate), rate / std::gcd(rate, output_rate), 16> interpolator_type;
 
 private:
 	typedef int8_t code_type;
+	typedef Modulation<cmplx, code_type> modulation_type;
 	static const int symbol_len = (1280 * rate) / 8000;
 	static const int guard_len = symbol_len / 8;
+	static const int interpolator_up = interpolator_type::up();
+	static const int interpolator_down = interpolator_type::down();
+	static const int output_max = ((symbol_len + guard_len) * interpolator_up + interpolator_down - 1) / interpolator_down + 1;
 	static const int bits_max = 16384;
 	static const int data_max = 1024;
 	static const int cols_max = 273 + 16;
@@ -47,6 +62,11 @@ private:
 	static const int mls1_len = 255;
 	static const int mls1_poly = 0b100101011;
 	static const int mls2_poly = 0b100101010001;
+	// The upper three bits of the mode byte in the metadata carry the number of code blocks
+	static const int burst_max = 8;
+	static const int burst_qam_rows = 4;
+	// Carriers of the metadata symbol: its MLS and, with reserved tones, the code carriers
+	static const int meta_max = cols_max + mls1_len + 1;
 			//37 chars, 11 lines high
 	static constexpr uint8_t base37_bitmap[407] = {
 		//SP, 0		1	  2     3     4     5     6     7     8     9     A     B     C     D     E     F     G     H     I     J     K     L     M     N     O     P     Q     R     S     T     U     V     W     X     Y     Z
@@ -67,22 +87,29 @@ private:
 	CODE::CRC<uint16_t> crc0;
 	CODE::CRC<uint32_t> crc1;
 	CODE::BoseChaudhuriHocquenghemEncoder<mls1_len, 71> bchenc;
-	CODE::PolarParityEncoder<code_type> polarenc;
+	CODE::PolarParityPackedEncoder<code_type> polarenc;
 	CODE::FisherYatesShuffle<1024> shuffle_1024;
 	CODE::FisherYatesShuffle<2048> shuffle_2048;
 	CODE::FisherYatesShuffle<4096> shuffle_4096;
 	CODE::FisherYatesShuffle<8192> shuffle_8192;
 	CODE::FisherYatesShuffle<16384> shuffle_16384;
 	uint8_t input_data[data_max];
-	code_type code[bits_max], mesg[bits_max];
+	code_type code[bits_max];
+	// Message and codeword of the polar encoder, one bit per bit
+	uint32_t mesg[bits_max/32], code_bits[bits_max/32];
 	cmplx fdom[symbol_len];
 	cmplx tdom[symbol_len];
 	cmplx temp[symbol_len];
 	cmplx kern[symbol_len];
 	cmplx guard[guard_len];
 	cmplx prev[cols_max];
+	// Constellation points of the data carriers of the current row
+	cmplx points[cols_max];
+	// Kernels of the configured modulation
+	const modulation_type *modulation = nullptr;
 	value papr_min, papr_max;
-	int16_t samples[symbol_len + guard_len];
+	interpolator_type interpolator;
+	int16_t samples[output_max];
 	int mod_bits;
 	int oper_mode;
 	int code_order; // Polar encoder order : 2**code_order = number of data bits
@@ -90,11 +117,22 @@ private:
 	int code_off;
 	int cons_cols;
 	int cons_rows;
+	int burst_len = burst_max;
 	int mls0_off;
 	int mls1_off;
 	int comb_dist = 1;
 	int comb_off = 1;
 	int reserved_tones = 0;
+	// The next data packet continues a burst
+	bool burst_continues = false;
+	// Time domain of the synchronization and the metadata symbol, rendered once per configuration
+	cmplx sync_tdom[symbol_len], meta_tdom[symbol_len];
+	// Carriers meta_lo .. meta_hi-1 of the cached metadata symbol, the data packets refer to them
+	cmplx meta_fdom[meta_max];
+	int meta_lo, meta_hi;
+	// Metadata word of the cached metadata symbol, including the mode and the number of blocks
+	uint64_t meta_key;
+	bool sync_cached = false, meta_cached = false;
 	void (*sampleSink)(int16_t samples[], int count) { nullptr }; 
 
 	static int bin(int carrier)
@@ -105,6 +143,23 @@ private:
 	{
 		return 1 - 2 * bit;
 	}
+	static int16_t quantize(value x)
+	{
+		return std::clamp<value>(std::nearbyint(32767 * x), -32768, 32767);
+	}
+	//! Appends a sample at the synthesis rate to the buffer, resampled to the output rate
+	int write(int count, value x)
+	{
+		if (interpolator_up == interpolator_down) {
+			samples[count] = quantize(x);
+			return count + 1;
+		}
+		value out[(interpolator_up + interpolator_down - 1) / interpolator_down];
+		int num = interpolator(out, x);
+		for (int i = 0; i < num; ++i)
+			samples[count++] = quantize(out[i]);
+		return count;
+	}
 	void clipping_and_filtering(value scale, bool limit)
 	{
 		for (int i = 0; i < symbol_len; ++i) {
@@ -145,10 +200,10 @@ private:
 	}
 
 	/**
-	 * @brief Generate a symbol
+	 * @brief Render fdom into tdom
 	 * @param papr_reduction Enable PAPR reduction
 	 */
-	void symbol(bool papr_reduction = true)
+	void render(bool papr_reduction)
 	{
 		// IFFT operation
 		bwd(tdom, fdom);
@@ -167,7 +222,11 @@ private:
 		// Remove zeros from the symbol
 		for (int i = 0; i < symbol_len; ++i)
 			tdom[i] = cmplx(std::min(value(1), tdom[i].real()), std::min(value(1), tdom[i].imag()));
+	}
 
+	//! Send tdom, behind the guard interval blended from the last symbol
+	void emit()
+	{
 		// Calculate the PAPR for the symbol, for reference purposes
 		value peak = 0, mean = 0;
 		for (int i = 0; i < symbol_len; ++i) {
@@ -192,52 +251,39 @@ private:
 		}
 
 		// Write the real part of the complex signals (guard & tdom) to a buffer.  Ignore the imaginary part.
+		int count = 0;
 		for (int i = 0; i < guard_len; ++i)
 		{	
 			// Write guard interval to the buffer
-			samples[i] = std::clamp<value>(std::nearbyint(32767 * guard[i].real()), -32768, 32767);
+			count = write(count, guard[i].real());
 			// Cyclic prefix [https://en.wikipedia.org/wiki/Cyclic_prefix]
 			guard[i] = tdom[i];
 		}
 		for (int i = 0; i < symbol_len; ++i)
 		{
 			// Write the OFDM-symbol to the buffer
-			samples[i + guard_len] = std::clamp<value>(std::nearbyint(32767 * tdom[i].real()), -32768, 32767);
+			count = write(count, tdom[i].real());
 		}
 		if(sampleSink)
 		{
 			// Send the buffer to the sampleSink
-			sampleSink(samples, symbol_len + guard_len);
+			sampleSink(samples, count);
 		}
 	}
 
-	cmplx mod_map(code_type *b)
+	/**
+	 * @brief Generate a symbol
+	 * @param papr_reduction Enable PAPR reduction
+	 */
+	void symbol(bool papr_reduction = true)
 	{
-		switch (mod_bits) {
-		case 2:
-			return PhaseShiftKeying<4, cmplx, code_type>::map(b);
-		case 3:
-			return PhaseShiftKeying<8, cmplx, code_type>::map(b);
-		case 4:
-			return QuadratureAmplitudeModulation<16, cmplx, code_type>::map(b);
-		case 6:
-			return QuadratureAmplitudeModulation<64, cmplx, code_type>::map(b);
-		}
-		return 0;
+		render(papr_reduction);
+		emit();
 	}
+
 	value mod_distance()
 	{
-		switch (mod_bits) {
-		case 2:
-			return PhaseShiftKeying<4, cmplx, code_type>::DIST;
-		case 3:
-			return PhaseShiftKeying<8, cmplx, code_type>::DIST;
-		case 4:
-			return QuadratureAmplitudeModulation<16, cmplx, code_type>::DIST;
-		case 6:
-			return QuadratureAmplitudeModulation<64, cmplx, code_type>::DIST;
-		}
-		return 2;
+		return modulation ? modulation->dist : 2;
 	}
 			
 public:
@@ -267,7 +313,13 @@ public:
 		oper_mode = modem_config->oper_mode;
 		int band_width = modem_config->band_width;
 		mod_bits = modem_config->mod_bits;
+		modulation = modulation_type::select(mod_bits);
 		cons_rows = modem_config->cons_rows;
+		// Without pilots, the amplitude errors of differential QAM add up from row to row,
+		// so bursts of these modes are limited to burst_qam_rows rows
+		burst_len = burst_max;
+		if (mod_bits > 3 && !modem_config->reserved_tones)
+			burst_len = std::max(1, burst_qam_rows / cons_rows);
 		int comb_cols = modem_config->comb_cols;
 		code_order = modem_config->code_order;
 		int code_cols = modem_config->code_cols;
@@ -289,6 +341,8 @@ public:
 			comb_off = comb_cols ? comb_dist / 2 : 1;
 			if (reserved_tones) {
 				value kern_fac = 1 / value(10 * reserved_tones);
+				// Only the reserved tones, not what the last symbol left in fdom
+				std::memset(fdom, 0, sizeof(fdom));
 				for (int i = 0, j = code_off - reserved_tones / 2; i < reserved_tones; ++i, ++j) {
 					if (j == code_off)
 						j += cons_cols;
@@ -297,6 +351,10 @@ public:
 				bwd(kern, fdom);
 			}
 		}
+		meta_lo = std::min(mls1_off - 1, code_off);
+		meta_hi = std::max(mls1_off + mls1_len, code_off + cons_cols);
+		assert(meta_hi - meta_lo <= meta_max);
+		sync_cached = meta_cached = false;
 		papr_min = 1000, papr_max = -1000;
 		return true;
 	}
@@ -359,9 +417,15 @@ public:
 	 * 
 	 * @note It must be sent at least once at the beginning of the transmission.  This allows the receiver to synchronize to the transmitter.
 	 * @note Schmidl-Cox synchronization symbol
+	 * @note Rendered once per configuration, then replayed.  fdom is only set when rendering.
 	 */
 	void synchronization_symbol()
 	{
+		if (sync_cached) {
+			std::memcpy(tdom, sync_tdom, sizeof(tdom));
+			emit();
+			return;
+		}
 		CODE::MLS seq0(mls0_poly);
 		value mls0_fac = std::sqrt(value(2 * symbol_len) / value(mls0_len));
 		std::memset(fdom, 0, sizeof(fdom));
@@ -370,17 +434,33 @@ public:
 			fdom[bin(2*i+mls0_off)] = nrz(seq0());
 		for (int i = 0; i < mls0_len; ++i)
 			fdom[bin(2*i+mls0_off)] *= fdom[bin(2*(i-1)+mls0_off)];
-		symbol(false);
+		render(false);
+		std::memcpy(sync_tdom, tdom, sizeof(tdom));
+		sync_cached = true;
+		emit();
 	}
 
 	/**
 	 * @brief Generate the metadata symbol
 	 * @param md Metadata to be sent, only lowest 55-8 bits will be used
-	 * @note This function will add the operating mode to the metadata.
+	 * @param blocks number of data packets following this metadata symbol, 1 .. getBurstMax()
+	 * @note This function will add the operating mode and the number of blocks to the metadata.
+	 * @note The last metadata symbol is kept until the next configure(), and replayed as long as
+	 * 	the metadata and the number of blocks stay the same.
 	 */
-	void metadata_symbol(uint64_t md)
+	void metadata_symbol(uint64_t md, int blocks = 1)
 	{
-		md = (md << 8) | oper_mode;
+		assert(blocks >= 1 && blocks <= burst_len);
+		md = (md << 8) | ((blocks - 1) << 5) | oper_mode;
+		burst_continues = false;
+		if (meta_cached && md == meta_key) {
+			std::memcpy(tdom, meta_tdom, sizeof(tdom));
+			std::memset(fdom, 0, sizeof(fdom));
+			for (int i = meta_lo; i < meta_hi; ++i)
+				fdom[bin(i)] = meta_fdom[i-meta_lo];
+			emit();
+			return;
+		}
 		uint8_t data[9] = { 0 }, // 71 bits : 55 bits of metadata + 16 bits of CRC
 			parity[23] = { 0 };	// 23*8 = 184 bits
 		// Total number of bits = 71 + 184 = 255
@@ -411,7 +491,13 @@ public:
 				fdom[bin(i)] = cons_fac * nrz(seq1());
 			}
 		}
-		symbol();
+		render(true);
+		std::memcpy(meta_tdom, tdom, sizeof(tdom));
+		for (int i = meta_lo; i < meta_hi; ++i)
+			meta_fdom[i-meta_lo] = fdom[bin(i)];
+		meta_key = md;
+		meta_cached = true;
+		emit();
 	}
 
 	/**
@@ -420,8 +506,9 @@ public:
 	 * @param data data bytes to be sent
 	 * @param len number of bytes to be sent
 	 * @return false when packet size is too large for the chosen operating mode
+	 * @note Within a burst, a data packet continues from the last symbol of the previous one.
 	 */
-	bool data_packet(uint8_t *data, int len)
+	bool data_packet(const uint8_t *data, int len)
 	{
 		if (len > (1 << (code_order - 4)))
 		{
@@ -436,15 +523,14 @@ public:
 		CODE::Xorshift32 scrambler;
 		for (int i = 0; i < data_bytes; ++i)
 			input_data[i] ^= scrambler();
-		// Convert the data to NRZ
-		for (int i = 0; i < data_bits; ++i)
-			mesg[i] = nrz(CODE::get_le_bit(input_data, i));
+		// Pack the data into words, least significant bit first
+		for (int i = 0; i < data_bits / 32; ++i)
+			mesg[i] = input_data[4*i] | input_data[4*i+1] << 8 | input_data[4*i+2] << 16 | uint32_t(input_data[4*i+3]) << 24;
 		// Add CRC parity bits
 		crc1.reset();
 		for (int i = 0; i < data_bytes; ++i)
 			crc1(input_data[i]);
-		for (int i = 0; i < 32; ++i)
-			mesg[i+data_bits] = nrz((crc1()>>i)&1);
+		mesg[data_bits / 32] = crc1();
 
 		/**
 		 * Polar encoding adds redundancy to the data to make it more robust against errors
@@ -452,43 +538,63 @@ public:
 		 */
 		switch(code_order) {
 		case 10:
-			polarenc(code, mesg, frozen_1024_562, code_order, 31, 3);
+			polarenc(code_bits, mesg, frozen_1024_562, code_order, 31, 3);
+			polarenc.unpack(code, code_bits, code_order);
 			shuffle_1024(code);
 			break;
 		case 11:
-			polarenc(code, mesg, frozen_2048_1090, code_order, 31, 3);
+			polarenc(code_bits, mesg, frozen_2048_1090, code_order, 31, 3);
+			polarenc.unpack(code, code_bits, code_order);
 			shuffle_2048(code);
 			break;
 		case 12:
-			polarenc(code, mesg, frozen_4096_2147, code_order, 31, 3);
+			polarenc(code_bits, mesg, frozen_4096_2147, code_order, 31, 3);
+			polarenc.unpack(code, code_bits, code_order);
 			shuffle_4096(code);
 			break;
 		case 13:
-			polarenc(code, mesg, frozen_8192_4261, code_order, 31, 5);
+			polarenc(code_bits, mesg, frozen_8192_4261, code_order, 31, 5);
+			polarenc.unpack(code, code_bits, code_order);
 			shuffle_8192(code);
 			break;
 		case 14:
-			polarenc(code, mesg, frozen_16384_8489, code_order, 31, 9);
+			polarenc(code_bits, mesg, frozen_16384_8489, code_order, 31, 9);
+			polarenc.unpack(code, code_bits, code_order);
 			shuffle_16384(code);
 			break;
 		}
 
 		// Modulating the data
-		for (int i = 0; i < cons_cols; ++i)
-			prev[i] = fdom[bin(i+code_off)];
+		// With reserved tones, the data carriers of all packets of a burst refer to the metadata symbol,
+		// the decoder keeps these references in phase with the pilots.  Otherwise the last symbol is the reference.
+		if (!reserved_tones || !burst_continues)
+			for (int i = 0; i < cons_cols; ++i)
+				prev[i] = fdom[bin(i+code_off)];
+		burst_continues = true;
 		CODE::MLS seq0(mls0_poly);
 		for (int j = 0, k = 0; j < cons_rows; ++j) {
-			for (int i = 0; i < cons_cols; ++i) {
-				if (/*oper_mode < 26*/!reserved_tones) {
-					prev[i] *= mod_map(code+k);
-					fdom[bin(i+code_off)] = prev[i];
-					k += mod_bits;
-				} else if (i % comb_dist == comb_off) {
-					prev[i] *= nrz(seq0());
+			if (/*oper_mode < 26*/!reserved_tones) {
+				modulation->map(points, code+k, cons_cols);
+				k += mod_bits * cons_cols;
+				for (int i = 0; i < cons_cols; ++i) {
+					prev[i] *= points[i];
 					fdom[bin(i+code_off)] = prev[i];
-				} else {
-					fdom[bin(i+code_off)] = prev[i] * mod_map(code+k);
-					k += mod_bits;
+				}
+			} else {
+				// The pilots split the row into runs of data carriers
+				for (int i = 0; i < cons_cols;) {
+					if (i % comb_dist == comb_off) {
+						prev[i] *= nrz(seq0());
+						fdom[bin(i+code_off)] = prev[i];
+						++i;
+						continue;
+					}
+					int pilot = i + (comb_off - i % comb_dist + comb_dist) % comb_dist;
+					int count = std::min(pilot, cons_cols) - i;
+					modulation->map(points + i, code+k, count);
+					k += mod_bits * count;
+					for (int end = i + count; i < end; ++i)
+						fdom[bin(i+code_off)] = prev[i] * points[i];
 				}
 			}
 			symbol();
@@ -497,6 +603,29 @@ public:
 		return true;
 	}
 
+	/**
+	 * @brief Send a message as bursts of up to getBurstMax() data packets behind one synchronization and metadata symbol
+	 * @param md Metadata to be sent, see metadata_symbol()
+	 * @param data message to be sent, split into packets of getPacketSize() bytes
+	 * @param len length of the message in bytes
+	 * @return number of bursts
+	 */
+	int burst(uint64_t md, const uint8_t *data, int len)
+	{
+		int packets = (len + packet_len - 1) / packet_len;
+		int bursts = 0;
+		for (int i = 0; i < packets; i += burst_len, ++bursts) {
+			int blocks = std::min(burst_len, packets - i);
+			synchronization_symbol();
+			metadata_symbol(md, blocks);
+			for (int j = 0; j < blocks; ++j) {
+				int offset = (i + j) * packet_len;
+				data_packet(data + offset, std::min(packet_len, len - offset));
+			}
+		}
+		return bursts;
+	}
+
 	/**
 	 * @brief Empty packet
 	 * 
@@ -520,10 +649,20 @@ public:
 	{
 		return guard_len;
 	}
+	//! Rate of the samples passed to the sample sink
+	int getOutputRate()
+	{
+		return output_rate;
+	}
 	size_t getPacketSize()
 	{
 		return packet_len;
 	}
+	//! Highest number of data packets in a burst
+	int getBurstMax()
+	{
+		return burst_len;
+	}
 };
 
 
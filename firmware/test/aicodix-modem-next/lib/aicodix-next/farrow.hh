@@ -0,0 +1,36 @@
+/*
+Fractional delay with a cubic Lagrange interpolator in Farrow structure
+
+The four taps are polynomials in the fractional delay mu, so a new
+delay only costs the evaluation of the polynomials and the delay can
+change from sample to sample, as needed for resampling.
+A cubic is only accurate well below the Nyquist frequency, so mix the
+signal down to baseband before interpolating it.
+*/
+
+#pragma once
+
+namespace DSP {
+
+template <typename TYPE, typename VALUE>
+class Farrow
+{
+	VALUE c0 = 0, c1 = 1, c2 = 0, c3 = 0;
+public:
+	// Interpolate between x[0] and x[1], with 0 <= mu < 1
+	void mu(VALUE m)
+	{
+		VALUE m1 = m + 1, m2 = m - 1, m3 = m - 2;
+		c0 = - m * m2 * m3 / 6;
+		c1 = m1 * m2 * m3 / 2;
+		c2 = - m1 * m * m3 / 2;
+		c3 = m1 * m * m2 / 6;
+	}
+	// Needs x[-1] .. x[2]
+	TYPE operator()(const TYPE *x)
+	{
+		return c0 * x[-1] + c1 * x[0] + c2 * x[1] + c3 * x[2];
+	}
+};
+
+}
@@ -0,0 +1,79 @@
+/*
+Rational polyphase FIR interpolator
+
+Resamples by UP / DOWN with a low pass filter at the Nyquist frequency
+of the input rate, made of the LowPass2 kernel and a Kaiser window.
+The filter is split into UP phases of TAPS coefficients each, so every
+output sample costs TAPS multiply-adds, whatever the ratio.
+E.g. 8 kHz to 48 kHz is 6 / 1 and 8 kHz to 44.1 kHz is 441 / 80.
+*/
+
+#pragma once
+
+#include "filter.hh"
+#include "window.hh"
+
+namespace DSP {
+
+template <typename TYPE, int UP, int DOWN, int TAPS>
+class Interpolator
+{
+	static_assert(UP >= DOWN, "only for interpolation");
+	TYPE coef[UP][TAPS];
+	TYPE hist[2*TAPS];
+	int pos = 0, phase = 0;
+public:
+	Interpolator(TYPE a = TYPE(2))
+	{
+		LowPass2<TYPE> filter(1, 2 * UP);
+		Kaiser<TYPE> window(a);
+		// Phase p holds the taps p, p+UP, p+2*UP, .. of the prototype filter
+		TYPE sum = 0;
+		for (int p = 0; p < UP; ++p)
+			for (int k = 0; k < TAPS; ++k)
+				sum += coef[p][k] = filter(p + k * UP, UP * TAPS) * window(p + k * UP, UP * TAPS);
+		// Unity gain, each phase sums to about one
+		for (int p = 0; p < UP; ++p)
+			for (int k = 0; k < TAPS; ++k)
+				coef[p][k] *= UP / sum;
+		for (int i = 0; i < 2*TAPS; ++i)
+			hist[i] = 0;
+	}
+	// Returns the number of output samples, at most (UP + DOWN - 1) / DOWN
+	int operator()(TYPE *output, TYPE input)
+	{
+		hist[pos] = hist[pos+TAPS] = input;
+		if (++pos == TAPS)
+			pos = 0;
+		// hist[pos+TAPS-1] is the newest sample
+		const TYPE *x = hist + pos + TAPS - 1;
+		int num = 0;
+		for (; phase < UP; phase += DOWN) {
+			TYPE sum = 0;
+			for (int k = 0; k < TAPS; ++k)
+				sum += coef[phase][k] * x[-k];
+			output[num++] = sum;
+		}
+		phase -= UP;
+		return num;
+	}
+	//! Prototype filter, coefficients()[p * TAPS + k] is tap p + k * UP
+	const TYPE *coefficients()
+	{
+		return coef[0];
+	}
+	static constexpr int up()
+	{
+		return UP;
+	}
+	static constexpr int down()
+	{
+		return DOWN;
+	}
+	static constexpr int taps()
+	{
+		return TAPS;
+	}
+};
+
+}
@@ -0,0 +1,188 @@
+/**
+ * @file link_adaptation.hh
+ * @brief Choice of the operating mode for each peer, from the Es/N0 of the frames received from it
+ * 	- Decoder::getEsN0() depends on the mode of the frame: the calibration table converts it
+ * 	  to the SNR of the channel, relative to the whole audio band at 8 kHz
+ * 	- Each peer keeps the SNR of its last HISTORY frames, the estimate is their mean less one standard deviation
+ * 	- select() takes the mode with the most payload bytes per symbol, whose threshold for the target
+ * 	  packet error rate lies at least the margin below the estimate.  Unknown peers get the most robust mode.
+ * @note The thresholds are the SNR at a packet error rate of 10 % on white noise, measured with link_bench,
+ * 	which also prints this table.  Fading channels need a larger margin.  Choosing the mode to send to a peer
+ * 	from the frames received from it assumes a reciprocal channel.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include "modem_config.hh"
+
+typedef struct {
+	int oper_mode;
+	float esn0_offset;	// Es/N0 reported by the decoder less the SNR of the channel, in dB
+	float snr_min;	// SNR of the channel at the target packet error rate, in dB
+} link_threshold_t;
+
+/// @brief Calibration of the modes with payload, see link_bench
+static const link_threshold_t link_thresholds[] =
+{
+	{ 20, 0.2, 8.6 },
+	{ 21, -0.7, 9.7 },
+	{ 22, -1.0, 14.8 },
+	{ 23, 0.6, 2.0 },
+	{ 24, 0.7, 5.9 },
+	{ 25, 0.9, 1.9 },
+	{ 26, -0.4, 9.8 },
+	{ 27, 0.1, 9.6 },
+	{ 28, 0.2, 10.0 },
+	{ 29, -0.3, 13.0 },
+	{ 30, -0.2, 13.0 }
+};
+
+template <typename value, int PEERS = 8, int HISTORY = 8>
+class LinkAdaptation
+{
+	struct Peer
+	{
+		uint64_t call_sign;
+		value snr[HISTORY];
+		int count;
+		uint32_t used;
+	};
+	Peer peers[PEERS];
+	int peer_count = 0;
+	uint32_t clock = 0;
+	value margin;
+
+	static const link_threshold_t *threshold(int mode)
+	{
+		for (auto &t : link_thresholds)
+			if (t.oper_mode == mode)
+				return &t;
+		return nullptr;
+	}
+
+	Peer *find(uint64_t call_sign)
+	{
+		for (int i = 0; i < peer_count; ++i)
+			if (peers[i].call_sign == call_sign)
+				return peers + i;
+		return nullptr;
+	}
+
+public:
+	/**
+	 * @param margin_db the estimated SNR must exceed the threshold of a mode by this much
+	 */
+	LinkAdaptation(value margin_db = 1) : margin(margin_db)
+	{
+	}
+
+	/**
+	 * @brief Add the Es/N0 of a frame to the history of its sender
+	 * @param call_sign call sign of the sender, see Decoder::staged()
+	 * @param mode operating mode of the frame
+	 * @param esn0 Decoder::getEsN0() of the frame, in dB
+	 * @return false for modes without calibration
+	 * @note The least recently heard peer makes room for a new one.
+	 */
+	bool update(uint64_t call_sign, int mode, value esn0)
+	{
+		const link_threshold_t *t = threshold(mode);
+		if (!t || !std::isfinite(esn0))
+			return false;
+		Peer *peer = find(call_sign);
+		if (!peer) {
+			if (peer_count < PEERS) {
+				peer = peers + peer_count++;
+			} else {
+				peer = peers;
+				for (int i = 1; i < PEERS; ++i)
+					if (peers[i].used < peer->used)
+						peer = peers + i;
+			}
+			peer->call_sign = call_sign;
+			peer->count = 0;
+		}
+		peer->snr[peer->count++ % HISTORY] = esn0 - t->esn0_offset;
+		peer->used = ++clock;
+		return true;
+	}
+
+	//! Estimated SNR of the channel from the peer in dB, minus infinity for unknown peers
+	value getSnr(uint64_t call_sign)
+	{
+		Peer *peer = find(call_sign);
+		if (!peer)
+			return -std::numeric_limits<value>::infinity();
+		int count = peer->count < HISTORY ? peer->count : HISTORY;
+		value sum = 0, sum2 = 0;
+		for (int i = 0; i < count; ++i) {
+			sum += peer->snr[i];
+			sum2 += peer->snr[i] * peer->snr[i];
+		}
+		value mean = sum / count;
+		value var = sum2 / count - mean * mean;
+		return mean - std::sqrt(var > 0 ? var : 0);
+	}
+
+	//! Payload bytes per symbol of a single packet, including the synchronization and metadata symbols
+	static value throughput(const modem_config_t *config)
+	{
+		return value((1 << (config->code_order - 4)) - 1) / (config->cons_rows + 2);
+	}
+
+	/**
+	 * @brief Configuration for sending to the peer, see Encoder::configure()
+	 * @return the mode with the highest throughput that the estimated SNR supports, or the most robust mode
+	 */
+	const modem_config_t *select(uint64_t call_sign)
+	{
+		value snr = getSnr(call_sign);
+		const modem_config_t *best = nullptr, *robust = nullptr;
+		value robust_snr = std::numeric_limits<value>::infinity();
+		for (auto &c : modem_configs) {
+			const link_threshold_t *t = threshold(c.oper_mode);
+			if (!t || !c.code_order)
+				continue;
+			if (t->snr_min < robust_snr) {
+				robust_snr = t->snr_min;
+				robust = &c;
+			}
+			if (t->snr_min + margin <= snr && (!best || throughput(&c) > throughput(best)))
+				best = &c;
+		}
+		return best ? best : robust;
+	}
+
+	//! Operating mode chosen for the peer
+	int getMode(uint64_t call_sign)
+	{
+		return select(call_sign)->oper_mode;
+	}
+
+	//! Drops the history of the peer
+	void forget(uint64_t call_sign)
+	{
+		Peer *peer = find(call_sign);
+		if (peer)
+			*peer = peers[--peer_count];
+	}
+
+	void setMargin(value margin_db)
+	{
+		margin = margin_db;
+	}
+
+	value getMargin()
+	{
+		return margin;
+	}
+
+	int getPeerCount()
+	{
+		return peer_count;
+	}
+};
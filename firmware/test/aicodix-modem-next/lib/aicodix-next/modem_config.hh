@@ -13,7 +13,7 @@ typedef struct {
 } modem_config_t;
 
 /// @brief Modem configurations
-static const modem_config_t modem_configs[] = 
+static constexpr modem_config_t modem_configs[] = 
 {
     { 0, 1600, 0, 0, 0, 0, 256, 0 },        // No payload
     { 20, 1600, 4, 1, 0, 10, 256, 0 },      // 64 bytes, QAM16
@@ -28,3 +28,12 @@ static const modem_config_t modem_configs[] =
     { 29, 1900, 6, 5, 16, 13, 273, 15 },    // 512 bytes, QAM64
     { 30, 1900, 6, 10, 16, 14, 273, 15 }    // 1024 bytes, QAM64
 };
+
+/// @brief Configuration of the operating mode, nullptr for unknown modes
+constexpr const modem_config_t *find_modem_config(int mode)
+{
+    for (auto &config : modem_configs)
+        if (config.oper_mode == mode)
+            return &config;
+    return nullptr;
+}
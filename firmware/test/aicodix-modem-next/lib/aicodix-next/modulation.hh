@@ -0,0 +1,70 @@
+/*
+Row kernels of the modulations, chosen once per frame
+
+The encoder and the decoder used to switch on the bits per point for
+every carrier.  Here each kernel is instantiated for one modulation and
+works on a whole run of carriers, so its loop has no dispatch left.
+select() looks the kernels up once, when a frame starts, and the
+encoder and decoder call them through the returned table.
+*/
+
+#pragma once
+
+#include "psk.hh"
+#include "qam.hh"
+#include "demapper.hh"
+
+template <typename cmplx, typename code_type>
+struct Modulation
+{
+	typedef typename cmplx::value_type value;
+	int bits;
+	// Distance between neighbouring constellation points
+	value dist;
+	// Constellation points of count groups of bits
+	void (*map)(cmplx *points, code_type *b, int count);
+	// Nearest constellation points, the hard decisions mapped back
+	void (*hard)(cmplx *points, const cmplx *c, int count);
+	// Soft bits, see SoftDemapper, returns the number of soft bits
+	int (*soft)(code_type *b, const cmplx *c, int count, value precision);
+
+	//! Kernels of the modulation with the given bits per point, nullptr if there is none
+	static const Modulation *select(int bits)
+	{
+		typedef SoftDemapper<cmplx, code_type> demapper;
+		static const Modulation table[] = {
+			kernels<PhaseShiftKeying<4, cmplx, code_type>>(demapper::psk4),
+			kernels<PhaseShiftKeying<8, cmplx, code_type>>(demapper::psk8),
+			kernels<QuadratureAmplitudeModulation<16, cmplx, code_type>>(demapper::qam16),
+			kernels<QuadratureAmplitudeModulation<64, cmplx, code_type>>(demapper::qam64),
+		};
+		for (auto &m : table)
+			if (m.bits == bits)
+				return &m;
+		return nullptr;
+	}
+
+private:
+	template <typename MOD>
+	static void map_row(cmplx *points, code_type *b, int count)
+	{
+		for (int i = 0; i < count; ++i)
+			points[i] = MOD::map(b + MOD::BITS * i);
+	}
+
+	template <typename MOD>
+	static void hard_row(cmplx *points, const cmplx *c, int count)
+	{
+		for (int i = 0; i < count; ++i) {
+			code_type tmp[MOD::BITS];
+			MOD::hard(tmp, c[i]);
+			points[i] = MOD::map(tmp);
+		}
+	}
+
+	template <typename MOD>
+	static constexpr Modulation kernels(int (*soft)(code_type *, const cmplx *, int, value))
+	{
+		return { MOD::BITS, MOD::DIST, map_row<MOD>, hard_row<MOD>, soft };
+	}
+};
@@ -239,6 +239,207 @@ public:
 	}
 };
 
+/*
+Same as OrderedStatisticsDecoder, but with the rows of the generator
+matrix packed into 64 bit words, so elimination and flips are word wise
+XORs. Candidates are kept as the difference to the hard decision: the
+metric sums up the reliabilities of the differing parity bits with
+nibble lookup tables and stops as soon as the candidate falls behind
+the best one. Subtrees of flips, which can not
+reach the best metric even if all parity bits agree with the hard
+decision, are skipped. This makes orders 3 and 4 affordable at usable
+SNR, while the decision is the same as with OrderedStatisticsDecoder.
+*/
+template <int N, int K, int O>
+class PackedOrderedStatisticsDecoder
+{
+	static_assert(O <= 4, "order above 4 not implemented");
+	static const int W = (N+63) / 64;
+	uint64_t G[W*K];
+	uint64_t decision[W], difference[W], candidate[W];
+	int8_t softperm[N];
+	int16_t perm[N];
+	int reliability[N];
+	// sums of the reliabilities for every nibble of the codeword
+	int16_t nibbles[W*16*16];
+	int total;
+	MergeSort<int16_t, N> sort;
+	static bool get(const uint64_t *row, int i)
+	{
+		return (row[i/64] >> (i%64)) & 1;
+	}
+	static void set(uint64_t *row, int i, bool val)
+	{
+		row[i/64] = (row[i/64] & ~(uint64_t(1) << (i%64))) | (uint64_t(val) << (i%64));
+	}
+	void swap_rows(int j, int k)
+	{
+		for (int i = 0; i < W; ++i)
+			std::swap(G[W*j+i], G[W*k+i]);
+	}
+	void xor_row(uint64_t *dst, int k)
+	{
+		for (int i = 0; i < W; ++i)
+			dst[i] ^= G[W*k+i];
+	}
+	void row_echelon()
+	{
+		for (int k = 0; k < K; ++k) {
+			// find pivot in this column
+			for (int j = k; j < K; ++j) {
+				if (get(G+W*j, k)) {
+					if (j != k)
+						swap_rows(j, k);
+					break;
+				}
+			}
+			// keep searching for suitable column for pivot
+			// beware: this will use columns >= K if necessary.
+			for (int j = k + 1; !get(G+W*k, k) && j < N; ++j) {
+				for (int h = k; h < K; ++h) {
+					if (get(G+W*h, j)) {
+						// account column swap
+						std::swap(perm[k], perm[j]);
+						for (int i = 0; i < K; ++i) {
+							bool tmp = get(G+W*i, k);
+							set(G+W*i, k, get(G+W*i, j));
+							set(G+W*i, j, tmp);
+						}
+						if (h != k)
+							swap_rows(h, k);
+						break;
+					}
+				}
+			}
+			assert(get(G+W*k, k));
+			// zero out column entries below pivot
+			for (int j = k + 1; j < K; ++j)
+				if (get(G+W*j, k))
+					xor_row(G+W*j, k);
+		}
+	}
+	void systematic()
+	{
+		for (int k = K-1; k; --k)
+			for (int j = 0; j < k; ++j)
+				if (get(G+W*j, k))
+					xor_row(G+W*j, k);
+	}
+	void flip(int j)
+	{
+		xor_row(difference, j);
+	}
+	// sum of (1 - 2 * codeword[i]) * softperm[i], or below least if it falls behind
+	int metric(int cost, int least)
+	{
+		int limit = total - cost - least;
+		int sum = 0;
+		for (int w = K / 64; w < W; ++w) {
+			uint64_t bits = difference[w];
+			if (w == K / 64)
+				bits &= ~uint64_t(0) << (K % 64);
+			const int16_t *table = nibbles + 16 * 16 * w;
+			for (int n = 0; bits; ++n, bits >>= 4)
+				sum += table[16*n+(bits&15)];
+			if (sum > limit)
+				return least - 1;
+		}
+		return total - cost - sum;
+	}
+public:
+	bool operator()(uint8_t *hard, const int8_t *soft, const int8_t *genmat)
+	{
+		for (int i = 0; i < N; ++i)
+			perm[i] = i;
+		for (int i = 0; i < N; ++i)
+			softperm[i] = std::abs(std::max<int8_t>(soft[i], -127));
+		sort(perm, N, [this](int a, int b){ return softperm[a] > softperm[b]; });
+		for (int j = 0; j < K; ++j) {
+			for (int w = 0; w < W; ++w) {
+				uint64_t row = 0;
+				for (int i = 64 * w; i < std::min(64 * w + 64, N); ++i)
+					row |= uint64_t(genmat[N*j+perm[i]]) << (i%64);
+				G[W*j+w] = row;
+			}
+		}
+		row_echelon();
+		systematic();
+		for (int i = 0; i < W; ++i)
+			decision[i] = difference[i] = 0;
+		total = 0;
+		for (int i = 0; i < N; ++i) {
+			softperm[i] = std::max<int8_t>(soft[perm[i]], -127);
+			set(decision, i, softperm[i] < 0);
+			reliability[i] = 2 * std::abs(softperm[i]);
+			total += std::abs(softperm[i]);
+		}
+		for (int n = 0; n < W * 16; ++n) {
+			nibbles[16*n] = 0;
+			for (int v = 1; v < 16; ++v) {
+				int i = 4 * n + __builtin_ctz(v);
+				nibbles[16*n+v] = nibbles[16*n+(v&(v-1))] + (i < N ? reliability[i] : 0);
+			}
+		}
+		// the codeword with the hard decision as message
+		for (int j = 0; j < K; ++j)
+			if (softperm[j] < 0)
+				flip(j);
+		for (int i = 0; i < W; ++i)
+			difference[i] ^= decision[i];
+		int best = metric(0, -total);
+		int next = -1;
+		for (int i = 0; i < W; ++i)
+			candidate[i] = difference[i];
+		auto update = [this, &best, &next](int cost) {
+			int met = metric(cost, best);
+			if (met > best) {
+				next = best;
+				best = met;
+				for (int i = 0; i < W; ++i)
+					candidate[i] = difference[i];
+			} else if (met > next && met == best) {
+				next = met;
+			}
+		};
+		// flipping message bits costs their reliability, no matter what the parity bits do
+		for (int a = 0; O >= 1 && a < K; ++a) {
+			int ca = reliability[a];
+			if (total - ca < best)
+				continue;
+			flip(a);
+			update(ca);
+			for (int b = a + 1; O >= 2 && b < K; ++b) {
+				int cb = ca + reliability[b];
+				if (total - cb < best)
+					continue;
+				flip(b);
+				update(cb);
+				for (int c = b + 1; O >= 3 && c < K; ++c) {
+					int cc = cb + reliability[c];
+					if (total - cc < best)
+						continue;
+					flip(c);
+					update(cc);
+					for (int d = c + 1; O >= 4 && d < K; ++d) {
+						int cd = cc + reliability[d];
+						if (total - cd < best)
+							continue;
+						flip(d);
+						update(cd);
+						flip(d);
+					}
+					flip(c);
+				}
+				flip(b);
+			}
+			flip(a);
+		}
+		for (int i = 0; i < N; ++i)
+			set_be_bit(hard, perm[i], get(candidate, i) ^ get(decision, i));
+		return best != next;
+	}
+};
+
 template <int N, int K, int O, int L>
 class OrderedStatisticsListDecoder
 {
@@ -7,6 +7,7 @@ Copyright 2023 Ahmet Inan <inan@aicodix.de>
 #pragma once
 
 #include "xorshift.hh"
+#include "shared_table.hh"
 
 namespace CODE {
 
@@ -25,19 +26,48 @@ struct FisherYatesShuffle
 template <int SIZE>
 class ReverseFisherYatesShuffle
 {
-	int seq[SIZE-1];
+	// The swap sequence is immutable and shared by all instances of the same size
+	struct Sequence
+	{
+		int seq[SIZE-1];
+		Sequence()
+		{
+			CODE::Xorshift32 prng;
+			for (int i = 0; i < SIZE-1; ++i)
+				seq[i] = i + prng() % (SIZE - i);
+		}
+	};
+	SharedTable<Sequence> sequence;
 public:
-	ReverseFisherYatesShuffle()
+	template <typename TYPE>
+	void operator()(TYPE *array)
+	{
+		const int *seq = sequence->seq;
+		for (int i = SIZE-2; i >= 0; --i)
+			std::swap(array[i], array[seq[i]]);
+	}
+};
+
+// Same permutation as ReverseFisherYatesShuffle, without the table:
+// the Xorshift32 sequence is run backwards from its last number
+template <int SIZE>
+class RewindFisherYatesShuffle
+{
+	uint32_t last;
+public:
+	RewindFisherYatesShuffle()
 	{
 		CODE::Xorshift32 prng;
 		for (int i = 0; i < SIZE-1; ++i)
-			seq[i] = i + prng() % (SIZE - i);
+			last = prng();
 	}
 	template <typename TYPE>
 	void operator()(TYPE *array)
 	{
-		for (int i = SIZE-2; i >= 0; --i)
-			std::swap(array[i], array[seq[i]]);
+		CODE::Xorshift32 prng(last);
+		uint32_t rnd = last;
+		for (int i = SIZE-2; i >= 0; --i, rnd = prng.prev())
+			std::swap(array[i], array[i + rnd % (SIZE - i)]);
 	}
 };
 
@@ -65,7 +65,9 @@ struct PolarParityNode
 	typedef PolarHelper<TYPE> PH;
 	typedef typename PH::PATH PATH;
 	typedef typename PH::MAP MAP;
+	typedef typename TYPE::value_type VALUE;
 	static const int N = 1 << M;
+	enum { OTHER, RATE0, RATE1, REP, SPC };
 	static MAP rate0(PATH *metric, TYPE *hard, TYPE *soft)
 	{
 		for (int i = 0; i < N; ++i)
@@ -79,6 +81,320 @@ struct PolarParityNode
 			map.v[k] = k;
 		return map;
 	}
+	static int kind(uint32_t frozen)
+	{
+		static_assert(N <= 32);
+		const uint32_t mask = N == 32 ? 0xffffffff : (1U << (N & 31)) - 1;
+		if (frozen == mask)
+			return RATE0;
+		if (frozen == 0)
+			return RATE1;
+		if (frozen == mask >> 1)
+			return REP;
+		if (frozen == 1)
+			return SPC;
+		return OTHER;
+	}
+	static int kind(const uint32_t *frozen)
+	{
+		static_assert(N >= 64);
+		const int W = N / 32;
+		bool zero = true, ones = true;
+		for (int i = 1; i < W-1; ++i) {
+			zero = zero && frozen[i] == 0;
+			ones = ones && frozen[i] == 0xffffffff;
+		}
+		if (ones && frozen[0] == 0xffffffff && frozen[W-1] == 0xffffffff)
+			return RATE0;
+		if (zero && frozen[0] == 0 && frozen[W-1] == 0)
+			return RATE1;
+		if (ones && frozen[0] == 0xffffffff && frozen[W-1] == 0x7fffffff)
+			return REP;
+		if (zero && frozen[0] == 1 && frozen[W-1] == 0)
+			return SPC;
+		return OTHER;
+	}
+	// Emits the message bits of the codeword in hard from bit first on, the paths forked before the first
+	static void emit(TYPE *message, MAP *maps, int *index, TYPE *hard, TYPE *soft, MAP map, int first, TYPE *parity, int *count)
+	{
+		// The lower half of soft is not used by this node, reuse it for the message bits
+		TYPE *mesg = soft;
+		for (int i = 0; i < N; ++i)
+			mesg[i] = hard[i];
+		for (int h = 1; h < N; h *= 2)
+			for (int i = 0; i < N; i += 2 * h)
+				for (int j = i; j < i + h; ++j)
+					mesg[j] = PH::qmul(mesg[j], mesg[j+h]);
+		MAP same;
+		for (int k = 0; k < TYPE::SIZE; ++k)
+			same.v[k] = k;
+		*parity = vshuf(*parity, map);
+		for (int i = first; i < N; ++i) {
+			message[*index] = mesg[i];
+			maps[*index] = i == first ? map : same;
+			*parity = PH::qmul(*parity, mesg[i]);
+			++*index;
+			--*count;
+		}
+	}
+	/*
+	The L best of the paths, either kept with the metric keep[k] or forked
+	with flip[k], in ascending order: perm[k] is 2*path+forked, best[k]
+	its metric.  Only the forks better than the worst kept path can make
+	it, they are sorted and merged with the sorted kept paths.
+	*/
+	static void select(int *perm, PATH *best, const PATH *keep, const PATH *flip)
+	{
+		const int L = TYPE::SIZE;
+		int kept[L], forked[L], order[L];
+		PATH keep_sorted[L], flip_sorted[L];
+		for (int k = 0; k < L; ++k)
+			keep_sorted[k] = keep[k];
+		CODE::insertion_sort(kept, keep_sorted, L);
+		int n = 0;
+		for (int k = 0; k < L; ++k) {
+			if (flip[k] < keep_sorted[L-1]) {
+				flip_sorted[n] = flip[k];
+				forked[n++] = k;
+			}
+		}
+		if (n)
+			CODE::insertion_sort(order, flip_sorted, n);
+		for (int k = 0, i = 0, j = 0; k < L; ++k) {
+			if (j < n && flip_sorted[j] < keep_sorted[i]) {
+				perm[k] = 2 * forked[order[j]] + 1;
+				best[k] = flip_sorted[j++];
+			} else {
+				perm[k] = 2 * kept[i];
+				best[k] = keep_sorted[i++];
+			}
+		}
+	}
+	/*
+	Fast-SSCL decoding of rate-1, repetition and single parity check nodes
+	for lists (TYPE::SIZE > 1), after Hashemi, Condo and Gross: "Fast and
+	Flexible Successive-Cancellation List Decoders for Polar Codes".
+	Repetition: every path forks into all zeros and all ones, or takes its
+	parity, when the bit is a parity bit.
+	Rate-1: starting from the hard decisions, the paths fork on flipping
+	their L-1 least reliable bits, one after the other.
+	SPC: the least reliable bit fixes the parity of the hard decisions,
+	then the paths fork on flipping each of their next least reliable bits
+	together with the least reliable one.
+	A flip adds the magnitude of the LLR to the path metric, or takes it
+	off again, when the bit was already flipped.
+	The forks only approximate the bitwise list: the surviving paths can
+	differ from it, without a measurable change of the frame error rate.
+	Returns false for rate-1 and SPC nodes holding a parity bit, they must
+	be decoded bit by bit.
+	*/
+	static bool list(int kind, PATH *metric, TYPE *message, MAP *maps, int *index, TYPE *hard, TYPE *soft, TYPE *parity, int *count, int stride, MAP *map)
+	{
+		const int L = TYPE::SIZE;
+		const int W = L < N ? L : N;
+		if ((kind == RATE1 && *count < N) || (kind == SPC && *count < N-1))
+			return false;
+		PATH keep[L], flip[L];
+		int perm[L];
+		if (kind == REP && !*count) {
+			for (int k = 0; k < L; ++k) {
+				keep[k] = metric[k];
+				for (int i = 0; i < N; ++i) {
+					int llr = soft[i+N].v[k];
+					if (parity->v[k] > 0 ? llr < 0 : llr > 0)
+						keep[k] += std::abs(llr);
+				}
+			}
+			CODE::insertion_sort(perm, keep, L);
+			for (int k = 0; k < L; ++k) {
+				metric[k] = keep[k];
+				map->v[k] = perm[k];
+			}
+			for (int i = 0; i < N; ++i)
+				for (int k = 0; k < L; ++k)
+					hard[i].v[k] = parity->v[perm[k]];
+			message[*index-1] = vshuf(message[*index-1], *map);
+			maps[*index-1] = vshuf(maps[*index-1], *map);
+			*parity = PH::one();
+			*count = stride;
+			return true;
+		}
+		if (kind == REP) {
+			for (int k = 0; k < L; ++k)
+				keep[k] = flip[k] = metric[k];
+			for (int i = 0; i < N; ++i) {
+				for (int k = 0; k < L; ++k) {
+					int llr = soft[i+N].v[k];
+					if (llr < 0)
+						keep[k] -= llr;
+					else
+						flip[k] += llr;
+				}
+			}
+			select(perm, metric, keep, flip);
+			for (int k = 0; k < L; ++k)
+				map->v[k] = perm[k] >> 1;
+			for (int i = 0; i < N; ++i)
+				for (int k = 0; k < L; ++k)
+					hard[i].v[k] = 1 - 2 * (perm[k] & 1);
+			emit(message, maps, index, hard, soft, *map, N-1, parity, count);
+			return true;
+		}
+		// The W least reliable bits of each lane, the least reliable first: positions and magnitudes
+		int least[L][W], mags[L][W];
+		for (int k = 0; k < L; ++k) {
+			for (int i = 0, n = 0; i < N; ++i) {
+				int mag = std::abs(int(soft[i+N].v[k]));
+				if (n == W && mag >= mags[k][W-1])
+					continue;
+				int j = n < W ? n++ : W-1;
+				for (; j > 0 && mag < mags[k][j-1]; --j) {
+					least[k][j] = least[k][j-1];
+					mags[k][j] = mags[k][j-1];
+				}
+				least[k][j] = i;
+				mags[k][j] = mag;
+			}
+		}
+		// Lane of each path before the node and its flipped bits, bit j for least[origin][j]
+		int origin[L], prev_origin[L];
+		uint32_t flips[L], prev_flips[L];
+		for (int k = 0; k < L; ++k) {
+			origin[k] = k;
+			flips[k] = 0;
+		}
+		int first = 0, steps = L-1 < N ? L-1 : N;
+		if (kind == SPC) {
+			for (int k = 0; k < L; ++k) {
+				bool odd = false;
+				for (int i = 0; i < N; ++i)
+					odd ^= soft[i+N].v[k] < 0;
+				if (odd) {
+					flips[k] = 1;
+					metric[k] += mags[k][0];
+				}
+			}
+			first = 1;
+			steps = W;
+		}
+		for (int t = first; t < steps; ++t) {
+			uint32_t bits = (1U << t) | (kind == SPC);
+			for (int k = 0; k < L; ++k) {
+				keep[k] = flip[k] = metric[k];
+				flip[k] += mags[origin[k]][t];
+				if (kind == SPC)
+					flip[k] += flips[k] & 1 ? -mags[origin[k]][0] : mags[origin[k]][0];
+			}
+			select(perm, metric, keep, flip);
+			for (int k = 0; k < L; ++k) {
+				prev_origin[k] = origin[k];
+				prev_flips[k] = flips[k];
+			}
+			for (int k = 0; k < L; ++k) {
+				origin[k] = prev_origin[perm[k]>>1];
+				flips[k] = prev_flips[perm[k]>>1] ^ (perm[k] & 1 ? bits : 0);
+			}
+		}
+		for (int i = 0; i < N; ++i)
+			for (int k = 0; k < L; ++k)
+				hard[i].v[k] = 1 - 2 * (soft[i+N].v[origin[k]] < 0);
+		for (int k = 0; k < L; ++k)
+			for (int j = 0; j < W; ++j)
+				if ((flips[k] >> j) & 1)
+					hard[least[origin[k]][j]].v[k] *= -1;
+		for (int k = 0; k < L; ++k)
+			map->v[k] = origin[k];
+		emit(message, maps, index, hard, soft, *map, first, parity, count);
+		return true;
+	}
+	/*
+	Fast-SSC decoding of rate-1, repetition and single parity check nodes
+	for successive cancellation (TYPE::SIZE == 1).
+	Returns false when a parity bit inside the node disagrees with the
+	decision, the node must then be decoded bit by bit.
+	*/
+	static bool fast(int kind, TYPE *message, MAP *maps, int *index, TYPE *hard, TYPE *soft, TYPE *parity, int *count, int stride)
+	{
+		int first = 0;
+		if (kind == REP) {
+			int sum = 0;
+			for (int i = 0; i < N; ++i)
+				sum += soft[i+N].v[0];
+			VALUE bit = *count ? 1 - 2 * (sum < 0) : parity->v[0];
+			for (int i = 0; i < N; ++i)
+				hard[i].v[0] = bit;
+			first = N-1;
+		} else {
+			for (int i = 0; i < N; ++i)
+				hard[i].v[0] = 1 - 2 * (soft[i+N].v[0] < 0);
+			if (kind == SPC) {
+				int worst = 0;
+				VALUE check = 1;
+				for (int i = 0; i < N; ++i) {
+					check *= hard[i].v[0];
+					if (std::abs(int(soft[i+N].v[0])) < std::abs(int(soft[worst+N].v[0])))
+						worst = i;
+				}
+				hard[worst].v[0] *= check;
+				first = 1;
+			}
+		}
+		// The lower half of soft is not used by this node, reuse it for the message bits
+		TYPE *mesg = soft;
+		for (int i = 0; i < N; ++i)
+			mesg[i] = hard[i];
+		for (int h = 1; h < N; h *= 2)
+			for (int i = 0; i < N; i += 2 * h)
+				for (int j = i; j < i + h; ++j)
+					mesg[j] = PH::qmul(mesg[j], mesg[j+h]);
+		VALUE par = parity->v[0];
+		for (int i = first, cnt = *count; i < N; ++i) {
+			if (cnt) {
+				par *= mesg[i].v[0];
+				--cnt;
+			} else if (mesg[i].v[0] != par) {
+				return false;
+			} else {
+				par = 1;
+				cnt = stride;
+			}
+		}
+		for (int i = first; i < N; ++i) {
+			if (*count) {
+				message[*index] = mesg[i];
+				maps[*index].v[0] = 0;
+				*parity = PH::qmul(*parity, mesg[i]);
+				++*index;
+				--*count;
+			} else {
+				*parity = PH::one();
+				*count = stride;
+			}
+		}
+		return true;
+	}
+	/*
+	Decodes rate-0, rate-1, repetition and single parity check nodes in
+	one step, fast() for successive cancellation and list() for lists.
+	Returns false when the node has to be decoded bit by bit.
+	*/
+	template <typename FROZEN>
+	static bool special(MAP *map, PATH *metric, TYPE *message, MAP *maps, int *index, TYPE *hard, TYPE *soft, FROZEN frozen, TYPE *parity, int *count, int stride)
+	{
+		int type = kind(frozen);
+		if (type == RATE0) {
+			*map = rate0(metric, hard, soft);
+			return true;
+		}
+		if (type == OTHER)
+			return false;
+		if constexpr (TYPE::SIZE == 1) {
+			map->v[0] = 0;
+			return fast(type, message, maps, index, hard, soft, parity, count, stride);
+		} else {
+			return list(type, metric, message, maps, index, hard, soft, parity, count, stride, map);
+		}
+	}
 };
 
 template <typename TYPE>
@@ -144,7 +460,7 @@ struct PolarParityNode<TYPE, 0>
 	}
 };
 
-template <typename TYPE, int M>
+template <typename TYPE, int M, bool SPECIAL = true>
 struct PolarParityTree
 {
 	typedef PolarHelper<TYPE> PH;
@@ -153,20 +469,23 @@ struct PolarParityTree
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *index, TYPE *hard, TYPE *soft, const uint32_t *frozen, TYPE *parity, int *count, int stride)
 	{
+		MAP map;
+		if (SPECIAL && PolarParityNode<TYPE, M>::special(&map, metric, message, maps, index, hard, soft, frozen, parity, count, stride))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
-		MAP lmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard, soft, frozen, parity, count, stride);
+		MAP lmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard, soft, frozen, parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::madd(hard[i], vshuf(soft[i+N], lmap), vshuf(soft[i+N/2+N], lmap));
-		MAP rmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard+N/2, soft, frozen+N/2/32, parity, count, stride);
+		MAP rmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard+N/2, soft, frozen+N/2/32, parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			hard[i] = PH::qmul(vshuf(hard[i], rmap), hard[i+N/2]);
 		return vshuf(lmap, rmap);
 	}
 };
 
-template <typename TYPE>
-struct PolarParityTree<TYPE, 6>
+template <typename TYPE, bool SPECIAL>
+struct PolarParityTree<TYPE, 6, SPECIAL>
 {
 	typedef PolarHelper<TYPE> PH;
 	typedef typename PH::PATH PATH;
@@ -175,27 +494,30 @@ struct PolarParityTree<TYPE, 6>
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *index, TYPE *hard, TYPE *soft, const uint32_t *frozen, TYPE *parity, int *count, int stride)
 	{
+		MAP map;
+		if (SPECIAL && PolarParityNode<TYPE, M>::special(&map, metric, message, maps, index, hard, soft, frozen, parity, count, stride))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
 		MAP lmap, rmap;
 		if (frozen[0] == 0xffffffff)
 			lmap = PolarParityNode<TYPE, M-1>::rate0(metric, hard, soft);
 		else
-			lmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard, soft, frozen[0], parity, count, stride);
+			lmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard, soft, frozen[0], parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::madd(hard[i], vshuf(soft[i+N], lmap), vshuf(soft[i+N/2+N], lmap));
 		if (frozen[1] == 0xffffffff)
 			rmap = PolarParityNode<TYPE, M-1>::rate0(metric, hard+N/2, soft);
 		else
-			rmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard+N/2, soft, frozen[1], parity, count, stride);
+			rmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard+N/2, soft, frozen[1], parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			hard[i] = PH::qmul(vshuf(hard[i], rmap), hard[i+N/2]);
 		return vshuf(lmap, rmap);
 	}
 };
 
-template <typename TYPE>
-struct PolarParityTree<TYPE, 5>
+template <typename TYPE, bool SPECIAL>
+struct PolarParityTree<TYPE, 5, SPECIAL>
 {
 	typedef PolarHelper<TYPE> PH;
 	typedef typename PH::PATH PATH;
@@ -204,27 +526,30 @@ struct PolarParityTree<TYPE, 5>
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *index, TYPE *hard, TYPE *soft, uint32_t frozen, TYPE *parity, int *count, int stride)
 	{
+		MAP map;
+		if (SPECIAL && PolarParityNode<TYPE, M>::special(&map, metric, message, maps, index, hard, soft, frozen, parity, count, stride))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
 		MAP lmap, rmap;
 		if ((frozen & ((1<<(1<<(M-1)))-1)) == ((1<<(1<<(M-1)))-1))
 			lmap = PolarParityNode<TYPE, M-1>::rate0(metric, hard, soft);
 		else
-			lmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard, soft, frozen & ((1<<(1<<(M-1)))-1), parity, count, stride);
+			lmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard, soft, frozen & ((1<<(1<<(M-1)))-1), parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::madd(hard[i], vshuf(soft[i+N], lmap), vshuf(soft[i+N/2+N], lmap));
 		if (frozen >> (N/2) == ((1<<(1<<(M-1)))-1))
 			rmap = PolarParityNode<TYPE, M-1>::rate0(metric, hard+N/2, soft);
 		else
-			rmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard+N/2, soft, frozen >> (N/2), parity, count, stride);
+			rmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard+N/2, soft, frozen >> (N/2), parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			hard[i] = PH::qmul(vshuf(hard[i], rmap), hard[i+N/2]);
 		return vshuf(lmap, rmap);
 	}
 };
 
-template <typename TYPE>
-struct PolarParityTree<TYPE, 4>
+template <typename TYPE, bool SPECIAL>
+struct PolarParityTree<TYPE, 4, SPECIAL>
 {
 	typedef PolarHelper<TYPE> PH;
 	typedef typename PH::PATH PATH;
@@ -233,27 +558,30 @@ struct PolarParityTree<TYPE, 4>
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *index, TYPE *hard, TYPE *soft, uint32_t frozen, TYPE *parity, int *count, int stride)
 	{
+		MAP map;
+		if (SPECIAL && PolarParityNode<TYPE, M>::special(&map, metric, message, maps, index, hard, soft, frozen, parity, count, stride))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
 		MAP lmap, rmap;
 		if ((frozen & ((1<<(1<<(M-1)))-1)) == ((1<<(1<<(M-1)))-1))
 			lmap = PolarParityNode<TYPE, M-1>::rate0(metric, hard, soft);
 		else
-			lmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard, soft, frozen & ((1<<(1<<(M-1)))-1), parity, count, stride);
+			lmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard, soft, frozen & ((1<<(1<<(M-1)))-1), parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::madd(hard[i], vshuf(soft[i+N], lmap), vshuf(soft[i+N/2+N], lmap));
 		if (frozen >> (N/2) == ((1<<(1<<(M-1)))-1))
 			rmap = PolarParityNode<TYPE, M-1>::rate0(metric, hard+N/2, soft);
 		else
-			rmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard+N/2, soft, frozen >> (N/2), parity, count, stride);
+			rmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard+N/2, soft, frozen >> (N/2), parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			hard[i] = PH::qmul(vshuf(hard[i], rmap), hard[i+N/2]);
 		return vshuf(lmap, rmap);
 	}
 };
 
-template <typename TYPE>
-struct PolarParityTree<TYPE, 3>
+template <typename TYPE, bool SPECIAL>
+struct PolarParityTree<TYPE, 3, SPECIAL>
 {
 	typedef PolarHelper<TYPE> PH;
 	typedef typename PH::PATH PATH;
@@ -262,27 +590,30 @@ struct PolarParityTree<TYPE, 3>
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *index, TYPE *hard, TYPE *soft, uint32_t frozen, TYPE *parity, int *count, int stride)
 	{
+		MAP map;
+		if (SPECIAL && PolarParityNode<TYPE, M>::special(&map, metric, message, maps, index, hard, soft, frozen, parity, count, stride))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
 		MAP lmap, rmap;
 		if ((frozen & ((1<<(1<<(M-1)))-1)) == ((1<<(1<<(M-1)))-1))
 			lmap = PolarParityNode<TYPE, M-1>::rate0(metric, hard, soft);
 		else
-			lmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard, soft, frozen & ((1<<(1<<(M-1)))-1), parity, count, stride);
+			lmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard, soft, frozen & ((1<<(1<<(M-1)))-1), parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::madd(hard[i], vshuf(soft[i+N], lmap), vshuf(soft[i+N/2+N], lmap));
 		if (frozen >> (N/2) == ((1<<(1<<(M-1)))-1))
 			rmap = PolarParityNode<TYPE, M-1>::rate0(metric, hard+N/2, soft);
 		else
-			rmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard+N/2, soft, frozen >> (N/2), parity, count, stride);
+			rmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard+N/2, soft, frozen >> (N/2), parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			hard[i] = PH::qmul(vshuf(hard[i], rmap), hard[i+N/2]);
 		return vshuf(lmap, rmap);
 	}
 };
 
-template <typename TYPE>
-struct PolarParityTree<TYPE, 2>
+template <typename TYPE, bool SPECIAL>
+struct PolarParityTree<TYPE, 2, SPECIAL>
 {
 	typedef PolarHelper<TYPE> PH;
 	typedef typename PH::PATH PATH;
@@ -291,27 +622,30 @@ struct PolarParityTree<TYPE, 2>
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *index, TYPE *hard, TYPE *soft, uint32_t frozen, TYPE *parity, int *count, int stride)
 	{
+		MAP map;
+		if (SPECIAL && PolarParityNode<TYPE, M>::special(&map, metric, message, maps, index, hard, soft, frozen, parity, count, stride))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
 		MAP lmap, rmap;
 		if ((frozen & ((1<<(1<<(M-1)))-1)) == ((1<<(1<<(M-1)))-1))
 			lmap = PolarParityNode<TYPE, M-1>::rate0(metric, hard, soft);
 		else
-			lmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard, soft, frozen & ((1<<(1<<(M-1)))-1), parity, count, stride);
+			lmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard, soft, frozen & ((1<<(1<<(M-1)))-1), parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::madd(hard[i], vshuf(soft[i+N], lmap), vshuf(soft[i+N/2+N], lmap));
 		if (frozen >> (N/2) == ((1<<(1<<(M-1)))-1))
 			rmap = PolarParityNode<TYPE, M-1>::rate0(metric, hard+N/2, soft);
 		else
-			rmap = PolarParityTree<TYPE, M-1>::decode(metric, message, maps, index, hard+N/2, soft, frozen >> (N/2), parity, count, stride);
+			rmap = PolarParityTree<TYPE, M-1, SPECIAL>::decode(metric, message, maps, index, hard+N/2, soft, frozen >> (N/2), parity, count, stride);
 		for (int i = 0; i < N/2; ++i)
 			hard[i] = PH::qmul(vshuf(hard[i], rmap), hard[i+N/2]);
 		return vshuf(lmap, rmap);
 	}
 };
 
-template <typename TYPE>
-struct PolarParityTree<TYPE, 1>
+template <typename TYPE, bool SPECIAL>
+struct PolarParityTree<TYPE, 1, SPECIAL>
 {
 	typedef PolarHelper<TYPE> PH;
 	typedef typename PH::PATH PATH;
@@ -334,7 +668,8 @@ struct PolarParityTree<TYPE, 1>
 	}
 };
 
-template <typename TYPE, int MAX_M>
+// Without SPECIAL, every node is decoded bit by bit, for comparison
+template <typename TYPE, int MAX_M, bool SPECIAL = true>
 class PolarParityDecoder
 {
 	static_assert(MAX_M >= 5 && MAX_M <= 16);
@@ -362,18 +697,18 @@ public:
 		int count = first;
 
 		switch (level) {
-		case 5: PolarParityTree<TYPE, 5>::decode(metric, message, maps, &index, hard, soft, *frozen, &parity, &count, stride); break;
-		case 6: PolarParityTree<TYPE, 6>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
-		case 7: PolarParityTree<TYPE, 7>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
-		case 8: PolarParityTree<TYPE, 8>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
-		case 9: PolarParityTree<TYPE, 9>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
-		case 10: PolarParityTree<TYPE, 10>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
-		case 11: PolarParityTree<TYPE, 11>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
-		case 12: PolarParityTree<TYPE, 12>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
-		case 13: PolarParityTree<TYPE, 13>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
-		case 14: PolarParityTree<TYPE, 14>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
-		case 15: PolarParityTree<TYPE, 15>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
-		case 16: PolarParityTree<TYPE, 16>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
+		case 5: PolarParityTree<TYPE, 5, SPECIAL>::decode(metric, message, maps, &index, hard, soft, *frozen, &parity, &count, stride); break;
+		case 6: PolarParityTree<TYPE, 6, SPECIAL>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
+		case 7: PolarParityTree<TYPE, 7, SPECIAL>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
+		case 8: PolarParityTree<TYPE, 8, SPECIAL>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
+		case 9: PolarParityTree<TYPE, 9, SPECIAL>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
+		case 10: PolarParityTree<TYPE, 10, SPECIAL>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
+		case 11: PolarParityTree<TYPE, 11, SPECIAL>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
+		case 12: PolarParityTree<TYPE, 12, SPECIAL>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
+		case 13: PolarParityTree<TYPE, 13, SPECIAL>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
+		case 14: PolarParityTree<TYPE, 14, SPECIAL>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
+		case 15: PolarParityTree<TYPE, 15, SPECIAL>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
+		case 16: PolarParityTree<TYPE, 16, SPECIAL>::decode(metric, message, maps, &index, hard, soft, frozen, &parity, &count, stride); break;
 		default: assert(false);
 		}
 
@@ -0,0 +1,132 @@
+/*
+Parity aided encoding of polar codes, one bit per bit
+
+Same code as PolarParityEncoder, but the bits are packed into words:
+bit i of a vector is (v[i/32] >> (i%32)) & 1, and a set bit stands for
+the -1 of PolarParityEncoder.  Multiplying NRZ values becomes XOR, so
+each butterfly stage works on 32 bits at once: within a word by shifts
+and masks, across words by XOR of whole words.  The message is copied
+in runs of up to 32 bits, each run of stride bits followed by its
+parity, and then spread over the free positions of the codeword.  Words
+without frozen bits take 32 bits at once.
+unpack() turns the codeword into the NRZ values of PolarParityEncoder,
+eight bits at a time through a table.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+namespace CODE {
+
+template <typename TYPE>
+class PolarParityPackedEncoder
+{
+	TYPE lut[256][8];
+	// Lowest count bits set, all of them from 32 on
+	static uint32_t mask(int count)
+	{
+		return count < 32 ? (1u << count) - 1 : ~0u;
+	}
+	// Without a popcount instruction, __builtin_popcount becomes a library call
+	static int ones(uint32_t x)
+	{
+		x = x - ((x >> 1) & 0x55555555);
+		x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+		x = (x + (x >> 4)) & 0x0F0F0F0F;
+		return (x * 0x01010101) >> 24;
+	}
+	// count bits starting at bit pos
+	static uint32_t get(const uint32_t *bits, int pos, int count)
+	{
+		if (!count)
+			return 0;
+		int off = pos % 32;
+		uint32_t tmp = bits[pos/32] >> off;
+		if (off + count > 32)
+			tmp |= bits[pos/32+1] << (32 - off);
+		return tmp & mask(count);
+	}
+	// Sets count bits starting at bit pos, the bits above them are cleared
+	static void put(uint32_t *bits, int pos, uint32_t val, int count)
+	{
+		int off = pos % 32;
+		if (!off)
+			bits[pos/32] = val;
+		else
+			bits[pos/32] = (bits[pos/32] & mask(off)) | val << off;
+		if (off + count > 32)
+			bits[pos/32+1] = val >> (32 - off);
+	}
+public:
+	PolarParityPackedEncoder()
+	{
+		for (int j = 0; j < 256; ++j)
+			for (int i = 0; i < 8; ++i)
+				lut[j][i] = 1 - 2 * ((j >> i) & 1);
+	}
+	void unpack(TYPE *codeword, const uint32_t *bits, int level)
+	{
+		int length = 1 << level;
+		for (int i = 0; i < length; i += 8) {
+			const TYPE *values = lut[(bits[i/32] >> (i%32)) & 255];
+			for (int j = 0; j < 8 && i + j < length; ++j)
+				codeword[i+j] = values[j];
+		}
+	}
+	void operator()(uint32_t *codeword, const uint32_t *message, const uint32_t *frozen, int level, int stride, int first)
+	{
+		int length = 1 << level;
+		int words = (length + 31) / 32;
+		// The information bits in order: runs of message bits, each but the last followed by its parity
+		int total = 0;
+		for (int w = 0; w < words; ++w)
+			total += ones(~frozen[w] & mask(length - 32 * w));
+		for (int pos = 0, index = 0, run = first; pos < total; run = stride) {
+			uint32_t parity = 0;
+			for (int n = 0; n < run && pos < total;) {
+				int count = std::min(std::min(run - n, 32), total - pos);
+				uint32_t bits = get(message, index, count);
+				put(codeword, pos, bits, count);
+				parity ^= bits;
+				index += count;
+				pos += count;
+				n += count;
+			}
+			if (pos < total)
+				put(codeword, pos++, ones(parity) & 1, 1);
+		}
+		// Spread them over the free positions in place, from the last word down
+		for (int w = words - 1, pos = total; w >= 0; --w) {
+			uint32_t free = ~frozen[w] & mask(length - 32 * w);
+			int count = ones(free);
+			pos -= count;
+			uint32_t bits = get(codeword, pos, count), word = 0;
+			if (count == 32) {
+				word = bits;
+			} else {
+				// One run of free positions at a time
+				while (free) {
+					int j = __builtin_ctz(free);
+					uint32_t rest = ~(free >> j);
+					int n = rest ? __builtin_ctz(rest) : 32 - j;
+					word |= (bits & mask(n)) << j;
+					bits >>= n;
+					free &= ~(mask(n) << j);
+				}
+			}
+			codeword[w] = word;
+		}
+		static const uint32_t even[5] = { 0x55555555, 0x33333333, 0x0F0F0F0F, 0x00FF00FF, 0x0000FFFF };
+		for (int h = 1, k = 0; h < length && h < 32; h *= 2, ++k)
+			for (int w = 0; w < words; ++w)
+				codeword[w] ^= (codeword[w] >> h) & even[k];
+		for (int h = 1; h < words; h *= 2)
+			for (int i = 0; i < words; i += 2 * h)
+				for (int j = i; j < i + h; ++j)
+					codeword[j] ^= codeword[j+h];
+	}
+};
+
+}
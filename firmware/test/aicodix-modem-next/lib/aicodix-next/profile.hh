@@ -0,0 +1,158 @@
+/**
+ * @file profile.hh
+ * @brief Per-stage profiling of the OFDM decoder
+ * 	- Scoped timers measure the total (inclusive) and self (exclusive) time of each stage
+ * 	- Counters record events like sync detections and decoding failures
+ * 	- dump() writes the results as JSON
+ * @note Profiling is compiled in only when MODEM_PROFILE is defined.  Otherwise all members are
+ * 	empty and the compiler removes the hooks entirely.
+ * 	The clock is the CPU cycle counter on the ESP32 and std::chrono::steady_clock elsewhere.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#ifdef MODEM_PROFILE
+#ifdef ESP32
+#include "hal/cpu_hal.h"
+#include "sdkconfig.h"
+#else
+#include <chrono>
+#endif
+#endif
+
+class Profile
+{
+public:
+	enum Stage
+	{
+		FEED,			// Decoder::feed(), DC block, Hilbert, bip buffer and correlator
+		CORRELATOR,		// SchmidlCox::operator()
+		PREAMBLE,		// metadata symbol, including BCH and OSD
+		BCH,			// BoseChaudhuriHocquenghemDecoder of the hard decisions
+		OSD,			// PackedOrderedStatisticsDecoder, only if BCH fails
+		DEMODULATE,		// one symbol per block, including FFT and Theil-Sen
+		FFT,
+		THEIL_SEN,
+		DEMAP,			// Es/N0 estimation and soft demapping
+		SHUFFLE,		// ReverseFisherYatesShuffle
+		POLAR,			// PolarParityDecoder
+		CRC,			// CRC32 check of the list candidates
+		STAGE_COUNT
+	};
+	enum Counter
+	{
+		SYNC_DETECT,
+		PREAMBLE_FAIL,	// OSD or header CRC failure
+		PAYLOAD_FAIL,
+		PAYLOAD_OKAY,
+		COUNTER_COUNT
+	};
+
+#ifdef MODEM_PROFILE
+private:
+#ifdef ESP32
+	typedef uint32_t tick_type;
+	static tick_type now()
+	{
+		return cpu_hal_get_cycle_count();
+	}
+	static double ticks_per_us()
+	{
+		return CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ;
+	}
+#else
+	typedef uint64_t tick_type;
+	static tick_type now()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	static double ticks_per_us()
+	{
+		return 1000;
+	}
+#endif
+	uint64_t total[STAGE_COUNT], self[STAGE_COUNT], calls[STAGE_COUNT], counters[COUNTER_COUNT];
+	struct Frame
+	{
+		Frame *parent;
+		tick_type start;
+		uint64_t children;
+	} *current = nullptr;
+
+public:
+	class Scope
+	{
+		Profile &profile;
+		Stage stage;
+		Frame frame;
+	public:
+		Scope(Profile &profile, Stage stage) : profile(profile), stage(stage), frame { profile.current, 0, 0 }
+		{
+			profile.current = &frame;
+			frame.start = now();
+		}
+		~Scope()
+		{
+			// Unsigned difference, so a wrapping cycle counter is handled
+			uint64_t elapsed = tick_type(now() - frame.start);
+			profile.total[stage] += elapsed;
+			profile.self[stage] += elapsed - frame.children;
+			++profile.calls[stage];
+			profile.current = frame.parent;
+			if (frame.parent)
+				frame.parent->children += elapsed;
+		}
+	};
+	Profile()
+	{
+		reset();
+	}
+	void reset()
+	{
+		for (int i = 0; i < STAGE_COUNT; ++i)
+			total[i] = self[i] = calls[i] = 0;
+		for (int i = 0; i < COUNTER_COUNT; ++i)
+			counters[i] = 0;
+	}
+	void count(Counter counter, int n = 1)
+	{
+		counters[counter] += n;
+	}
+	void dump(std::ostream &os) const
+	{
+		static const char *const stage_names[STAGE_COUNT] = {
+			"feed", "correlator", "preamble", "bch", "osd", "demodulate",
+			"fft", "theil_sen", "demap", "shuffle", "polar", "crc" };
+		static const char *const counter_names[COUNTER_COUNT] = {
+			"sync_detect", "preamble_fail", "payload_fail", "payload_okay" };
+		os << "{\"unit\": \"us\", \"stages\": {";
+		for (int i = 0; i < STAGE_COUNT; ++i)
+			os << (i ? ", " : "") << '"' << stage_names[i] << "\": {\"calls\": " << calls[i]
+				<< ", \"total\": " << uint64_t(total[i] / ticks_per_us())
+				<< ", \"self\": " << uint64_t(self[i] / ticks_per_us()) << '}';
+		os << "}, \"counters\": {";
+		for (int i = 0; i < COUNTER_COUNT; ++i)
+			os << (i ? ", " : "") << '"' << counter_names[i] << "\": " << counters[i];
+		os << "}}";
+	}
+#else
+	struct Scope
+	{
+		Scope(Profile &, Stage) {}
+	};
+	void reset() {}
+	void count(Counter, int = 1) {}
+	void dump(std::ostream &os) const
+	{
+		os << "{}";
+	}
+#endif
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+//! Time the rest of the enclosing block as the given Profile::Stage
+#define PROFILE_SCOPE(profile, stage) Profile::Scope PROFILE_CONCAT(profile_scope_, __LINE__)(profile, Profile::stage)
@@ -0,0 +1,63 @@
+/*
+Repeated median estimator
+
+Siegel's repeated median: the slope is the median over all points of
+the median slope to all other points. Same interface and robustness
+as the Theil–Sen estimator, but only needs O(LEN_MAX) memory instead
+of O(LEN_MAX²).
+
+Copyright (c) 2024
+*/
+
+#pragma once
+
+#include "quick.hh"
+
+namespace DSP {
+
+template <typename TYPE, int LEN_MAX>
+class RepeatedMedianEstimator
+{
+	TYPE temp_[LEN_MAX], meds_[LEN_MAX];
+	TYPE xint_, yint_, slope_;
+public:
+	RepeatedMedianEstimator() : xint_(0), yint_(0), slope_(0) {}
+	void compute(const TYPE *x, const TYPE *y, int LEN)
+	{
+		if (LEN > LEN_MAX)
+			LEN = LEN_MAX;
+		int count = 0;
+		for (int i = 0; i < LEN; ++i) {
+			int num = 0;
+			for (int j = 0; j < LEN; ++j)
+				if (x[j] != x[i])
+					temp_[num++] = (y[j] - y[i]) / (x[j] - x[i]);
+			if (num)
+				meds_[count++] = quick_select(temp_, num/2, num);
+		}
+		slope_ = count ? quick_select(meds_, count/2, count) : 0;
+		for (int i = 0; i < LEN; ++i)
+			temp_[i] = y[i] - slope_ * x[i];
+		yint_ = LEN ? quick_select(temp_, LEN/2, LEN) : 0;
+		xint_ = - yint_ / slope_;
+	}
+	TYPE xint()
+	{
+		return xint_;
+	}
+	TYPE slope()
+	{
+		return slope_;
+	}
+	TYPE yint()
+	{
+		return yint_;
+	}
+	TYPE operator () (TYPE x)
+	{
+		return yint_ + slope_ * x;
+	}
+};
+
+}
+
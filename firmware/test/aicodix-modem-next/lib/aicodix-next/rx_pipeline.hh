@@ -0,0 +1,138 @@
+/**
+ * @file rx_pipeline.hh
+ * @brief Receiver split into two stages, that run on different cores
+ * 	- Front end: decimator, DC blocker, Hilbert filter and Schmidl-Cox correlator of a Synchronizer, for every block
+ * 	- Back end: Decoder without the correlator, demodulation and FEC
+ * 	- The blocks go from the front end to the back end through a wait-free SpscRing, together with their Detection
+ * @note While the back end spends seconds in Decoder::fetch(), the front end keeps up with the audio and the
+ * 	blocks queue up, so no packet following back to back gets lost.  The front end never blocks, when the
+ * 	queue is full the block is dropped and counted in getOverruns().  The next block that gets through
+ * 	carries a gap flag, and the back end resets its Decoder instead of joining the samples on both sides.
+ * 	SpscRing.h comes with the I2SAudio library.  Neither class depends on FreeRTOS, so the pipeline can run
+ * 	with std::thread on Linux, see firmware/host/pipeline_bench.cpp.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include "SpscRing.h"
+#include "decode.hh"
+
+/**
+ * @tparam DEPTH number of queued blocks, must be a power of two.  16 blocks are 2.9 s at 8 kHz.
+ * @tparam input_rate rate of the samples passed to frontend(), a multiple of rate.  The front end decimates
+ * 	them and queues the blocks at rate, so the queue and the back end stay the same.
+ */
+template <typename value, typename cmplx, int rate, int DEPTH = 16, template <typename, int> class SlopeEstimator = DefaultSlopeEstimator, int input_rate = rate>
+class RxPipeline
+{
+public:
+	typedef Decoder<value, cmplx, rate, SlopeEstimator> decoder_type;
+	typedef Synchronizer<value, cmplx, rate, input_rate> sync_type;
+	static const int extended_len = sync_type::extended_len;
+	static const int input_len = sync_type::input_len;
+private:
+	struct Block
+	{
+		int16_t samples[extended_len];
+		typename sync_type::Detection detection;
+		// Blocks were dropped right before this one
+		bool gap;
+	};
+	Profile front_profile;
+	sync_type sync;
+	Block front_block, back_block;
+	SpscRing<Block, DEPTH> blocks;
+	decoder_type decoder;
+	// Only used by the front end
+	bool gap = false;
+	// Only used by the back end
+	uint32_t gaps = 0;
+public:
+	RxPipeline() : sync(front_profile)
+	{
+	}
+
+	/**
+	 * @brief Front end, feed a block of audio samples
+	 * @param samples mono 16-bit audio samples at input_rate
+	 * @param count must be getInputLen(), so the blocks of both stages stay aligned
+	 * @return false when the back end fell behind and the block was dropped
+	 */
+	bool frontend(const int16_t *samples, int count)
+	{
+		assert(count == input_len);
+		sync(samples, count);
+		samples = sync.samples(&count);
+		assert(count == extended_len);
+		std::memcpy(front_block.samples, samples, sizeof(front_block.samples));
+		front_block.detection = sync.detection();
+		front_block.gap = gap;
+		gap = blocks.write(&front_block, 1) != 1;
+		return !gap;
+	}
+
+	/**
+	 * @brief Back end, process the oldest queued block
+	 * @return -1 when no block is waiting, the status of Decoder::process() otherwise.
+	 * 	On STATUS_DONE call getDecoder().fetch() before the next backend().
+	 * 	STATUS_FAIL when blocks were dropped in the middle of a frame, which is then aborted.
+	 */
+	int backend()
+	{
+		if (!blocks.read(&back_block, 1))
+			return -1;
+		bool aborted = false;
+		if (back_block.gap) {
+			++gaps;
+			aborted = decoder.reset();
+		}
+		decoder.feed(back_block.samples, extended_len, back_block.detection);
+		int status = decoder.process();
+		return aborted ? STATUS_FAIL : status;
+	}
+
+	//! Only to be used by the back end
+	decoder_type &getDecoder()
+	{
+		return decoder;
+	}
+
+	int getExtendedLen()
+	{
+		return extended_len;
+	}
+
+	//! Samples at input_rate per block of the front end
+	int getInputLen()
+	{
+		return input_len;
+	}
+
+	//! Number of blocks waiting for the back end
+	int getBacklog()
+	{
+		return blocks.available();
+	}
+
+	//! Number of blocks dropped because the queue was full
+	uint32_t getOverruns()
+	{
+		return blocks.overruns();
+	}
+
+	//! Number of gaps the back end has reset the decoder for, only to be used by the back end
+	uint32_t getGaps()
+	{
+		return gaps;
+	}
+
+	//! Profile of the front end, the back end uses getDecoder().getProfile()
+	Profile &getFrontProfile()
+	{
+		return front_profile;
+	}
+};
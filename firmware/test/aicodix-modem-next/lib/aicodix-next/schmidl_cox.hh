@@ -47,6 +47,7 @@ public:
 	int symbol_pos = 0;
 	value cfo_rad = 0;
 	value frac_cfo = 0;
+	value power = 0;
 
 	SchmidlCox(const cmplx *sequence) : threshold(value(0.17 * match_len), value(0.19 * match_len)) {
 		fwd(kern, sequence);
@@ -59,6 +60,7 @@ public:
 		value R = value(0.5) * pwr(norm(samples[search_pos + 2 * symbol_len]));
 		value min_R = 0.00001 * symbol_len;
 		R = std::max(R, min_R);
+		power = R;
 		value timing = match(norm(P) / (R * R));
 		value phase = align(arg(P));
 
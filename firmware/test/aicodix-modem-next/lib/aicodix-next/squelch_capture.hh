@@ -0,0 +1,386 @@
+/**
+ * @file squelch_capture.hh
+ * @brief Capture of the packets that break the squelch, decoded later from a queue
+ * 	- Squelch: energy gate on the power estimate of the Schmidl-Cox correlator, against a tracked noise floor
+ * 	- SquelchCapture front end: while the squelch is open, the blocks go into a frame of the capture store,
+ * 	  preceded by the blocks of the pre-roll.  Frames without a detected synchronization symbol are discarded.
+ * 	- SquelchCapture back end: replays the queued frames through a Decoder, one block per call
+ * @note Decoding takes longer than receiving, so a real-time receiver has to buffer the packets and decode them with
+ * 	a delay of a few seconds.  Unlike the RxPipeline, the store only holds the audio of the packets, not the noise in between.
+ * 	The frames go to the back end and back through two SpscRings of frame indices, so front end and back end can run
+ * 	on different cores without a lock.  The store is allocated in PSRAM on the ESP32, when available.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#if defined(ESP32) && defined(BOARD_HAS_PSRAM)
+#include "esp_heap_caps.h"
+#endif
+#include "SpscRing.h"
+#include "decode.hh"
+
+/**
+ * @brief Energy gate with hysteresis, evaluated once per block
+ * @note The noise floor follows the power down at once and up by 1 % per block, about 0.25 dB/s at 8 kHz.
+ * 	It starts from the power after the warm-up, as the estimate of the correlator lags the input by about three blocks.
+ */
+template <typename value>
+class Squelch
+{
+	value open_ratio, close_ratio;
+	int hangover;
+	int warmup;
+	value floor = 0;
+	int quiet = 0;
+	bool open = false;
+public:
+	/**
+	 * @param open_db power above the noise floor, that opens the squelch
+	 * @param close_db power above the noise floor, below which the squelch closes again
+	 * @param hangover number of quiet blocks before closing
+	 * @param warmup number of blocks ignored at the start
+	 */
+	Squelch(value open_db = 6, value close_db = 3, int hangover = 2, int warmup = 3) :
+		open_ratio(std::pow(value(10), open_db / 10)), close_ratio(std::pow(value(10), close_db / 10)), hangover(hangover), warmup(warmup)
+	{
+	}
+
+	//! Returns true while the squelch is open
+	bool operator()(value power)
+	{
+		if (warmup) {
+			--warmup;
+			return false;
+		}
+		if (!(floor > 0) || power < floor)
+			floor = power;
+		else
+			floor *= value(1.01);
+		if (power > floor * open_ratio) {
+			open = true;
+			quiet = 0;
+		} else if (open && power < floor * close_ratio && ++quiet > hangover) {
+			open = false;
+		}
+		return open;
+	}
+
+	value getFloor()
+	{
+		return floor;
+	}
+};
+
+/**
+ * @tparam FRAMES number of frames in the capture store, must be a power of two
+ * @tparam input_rate rate of the samples passed to frontend(), a multiple of rate.  The front end decimates
+ * 	them, so the store and the back end work at rate.
+ */
+template <typename value, typename cmplx, int rate, int FRAMES = 4, template <typename, int> class SlopeEstimator = DefaultSlopeEstimator, int input_rate = rate>
+class SquelchCapture
+{
+public:
+	typedef Decoder<value, cmplx, rate, SlopeEstimator> decoder_type;
+	typedef Synchronizer<value, cmplx, rate, input_rate> sync_type;
+	static const int extended_len = sync_type::extended_len;
+	static const int input_len = sync_type::input_len;
+	// The block that opened the squelch and the ones before, for the sample history of the Decoder and the delay of the power estimate
+	static const int pre_blocks = 5;
+	// Pre-roll, synchronization and metadata symbols, 32 payload symbols of the longest mode and some spare
+	static const int frame_blocks = pre_blocks + 36;
+private:
+	typedef typename sync_type::Detection Detection;
+	struct Frame
+	{
+		int16_t *samples;
+		Detection detections[frame_blocks];
+		int blocks;
+		bool detected;
+		// Follows the previous frame without a gap, because the squelch stayed open
+		bool continued;
+		uint32_t captured;
+	};
+	Profile front_profile;
+	sync_type sync;
+	Squelch<value> squelch;
+	int16_t *store;
+	Frame frames[FRAMES];
+	// Front end to back end and back again
+	SpscRing<int, FRAMES> ready, spare;
+	int16_t pre_samples[pre_blocks][extended_len];
+	Detection pre_detections[pre_blocks];
+	int pre_count = 0;
+	int pre_next = 0;
+	int current = -1;
+	bool capturing = false;
+	bool overflow = false;
+	int playing = -1;
+	int position = 0;
+	uint32_t backlog_limit = 0;
+	decoder_type decoder;
+	// Front end statistics
+	std::atomic<uint32_t> block_count{0};
+	std::atomic<uint32_t> captured_frames{0};
+	std::atomic<uint32_t> dropped_frames{0};
+	std::atomic<uint32_t> empty_frames{0};
+	std::atomic<int> max_depth{0};
+	// Back end statistics
+	uint32_t stale_frames = 0;
+	uint32_t decoded_frames = 0;
+	uint32_t last_latency = 0;
+	uint32_t max_latency = 0;
+	uint64_t sum_latency = 0;
+
+	static int16_t *allocate(size_t count)
+	{
+#if defined(ESP32) && defined(BOARD_HAS_PSRAM)
+		return static_cast<int16_t *>(heap_caps_malloc(count * sizeof(int16_t), MALLOC_CAP_SPIRAM));
+#else
+		return new int16_t[count];
+#endif
+	}
+	static void release(int16_t *ptr)
+	{
+#if defined(ESP32) && defined(BOARD_HAS_PSRAM)
+		heap_caps_free(ptr);
+#else
+		delete[] ptr;
+#endif
+	}
+	static int ms(uint32_t blocks)
+	{
+		return (uint64_t)blocks * extended_len * 1000 / rate;
+	}
+
+	void append(const int16_t *samples, const Detection &detection)
+	{
+		Frame &frame = frames[current];
+		std::memcpy(frame.samples + frame.blocks * extended_len, samples, sizeof(int16_t) * extended_len);
+		frame.detections[frame.blocks++] = detection;
+		frame.detected |= detection.check;
+	}
+	void start(bool preroll)
+	{
+		if (current < 0 && !spare.read(&current, 1)) {
+			// Store full, drop the new frame until the squelch closes
+			++dropped_frames;
+			overflow = true;
+			return;
+		}
+		capturing = true;
+		frames[current].blocks = 0;
+		frames[current].detected = false;
+		frames[current].continued = !preroll;
+		for (int i = 0; preroll && i < pre_count; ++i) {
+			int j = (pre_next + pre_blocks - pre_count + i) % pre_blocks;
+			append(pre_samples[j], pre_detections[j]);
+		}
+	}
+	void finish()
+	{
+		capturing = false;
+		if (!frames[current].detected && !frames[current].continued) {
+			// Noise or a packet too weak for the correlator, the frame is reused
+			++empty_frames;
+			return;
+		}
+		frames[current].captured = block_count;
+		ready.write(&current, 1);
+		current = -1;
+		++captured_frames;
+		int depth = ready.available();
+		if (depth > max_depth)
+			max_depth = depth;
+	}
+
+public:
+	SquelchCapture() : sync(front_profile), store(allocate(FRAMES * frame_blocks * extended_len))
+	{
+		assert(store);
+		for (int i = 0; i < FRAMES; ++i) {
+			frames[i].samples = store + i * frame_blocks * extended_len;
+			spare.write(&i, 1);
+		}
+	}
+	~SquelchCapture()
+	{
+		release(store);
+	}
+
+	/**
+	 * @brief Front end, feed a block of audio samples
+	 * @param samples mono 16-bit audio samples at input_rate
+	 * @param count must be getInputLen(), so the blocks of both stages stay aligned
+	 * @return true while the squelch is open
+	 */
+	bool frontend(const int16_t *samples, int count)
+	{
+		assert(count == input_len);
+		sync(samples, count);
+		samples = sync.samples(&count);
+		assert(count == extended_len);
+		const Detection &detection = sync.detection();
+		bool open = squelch(sync.power());
+		++block_count;
+		std::memcpy(pre_samples[pre_next], samples, sizeof(int16_t) * extended_len);
+		pre_detections[pre_next] = detection;
+		pre_next = (pre_next + 1) % pre_blocks;
+		if (pre_count < pre_blocks)
+			++pre_count;
+		if (capturing) {
+			append(samples, detection);
+			if (!open) {
+				finish();
+			} else if (frames[current].blocks == frame_blocks) {
+				// Squelch still open, the next frame continues where this one ends
+				finish();
+				start(false);
+			}
+		} else if (open && !overflow) {
+			start(true);
+		}
+		if (!open)
+			overflow = false;
+		return open;
+	}
+
+	/**
+	 * @brief Back end, process the next block of the oldest captured frame
+	 * @return -1 when no frame is waiting, the status of Decoder::process() otherwise.
+	 * 	On STATUS_DONE call getDecoder().fetch() before the next backend().
+	 * 	STATUS_FAIL when a new frame starts while the decoder is still in the middle of a packet, which is then aborted.
+	 */
+	int backend()
+	{
+		while (playing < 0) {
+			if (!ready.read(&playing, 1))
+				return -1;
+			position = 0;
+			if (backlog_limit && block_count - frames[playing].captured > backlog_limit) {
+				++stale_frames;
+				spare.write(&playing, 1);
+				playing = -1;
+			}
+		}
+		Frame &frame = frames[playing];
+		// The audio before the pre-roll is not what the decoder saw last, so it starts over
+		bool aborted = false;
+		if (position == 0 && !frame.continued)
+			aborted = decoder.reset();
+		decoder.feed(frame.samples + position * extended_len, extended_len, frame.detections[position]);
+		int status = decoder.process();
+		if (++position == frame.blocks) {
+			last_latency = block_count - frame.captured;
+			if (last_latency > max_latency)
+				max_latency = last_latency;
+			sum_latency += last_latency;
+			++decoded_frames;
+			spare.write(&playing, 1);
+			playing = -1;
+		}
+		return aborted ? STATUS_FAIL : status;
+	}
+
+	/**
+	 * @brief Backlog policy of the back end
+	 * @param limit_ms frames waiting longer are skipped, so the receiver catches up.  0 decodes every frame.
+	 * @note When the store is full, the front end always drops the new frames.
+	 */
+	void setBacklogLimit(int limit_ms)
+	{
+		backlog_limit = (uint64_t)limit_ms * rate / (extended_len * 1000);
+	}
+
+	//! Only to be used by the back end
+	decoder_type &getDecoder()
+	{
+		return decoder;
+	}
+
+	int getExtendedLen()
+	{
+		return extended_len;
+	}
+
+	//! Samples at input_rate per block of the front end
+	int getInputLen()
+	{
+		return input_len;
+	}
+
+	//! Size of the capture store in bytes
+	int getStoreSize()
+	{
+		return FRAMES * frame_blocks * extended_len * sizeof(int16_t);
+	}
+
+	//! Number of frames waiting for the back end
+	int getQueueDepth()
+	{
+		return ready.available();
+	}
+
+	//! Highest number of frames waiting for the back end so far
+	int getMaxQueueDepth()
+	{
+		return max_depth;
+	}
+
+	//! Number of frames with a detected synchronization symbol, that were queued
+	uint32_t getCapturedFrames()
+	{
+		return captured_frames;
+	}
+
+	//! Number of frames lost, because the store was full or they exceeded the backlog limit
+	uint32_t getDroppedFrames()
+	{
+		return dropped_frames + stale_frames;
+	}
+
+	//! Number of times the squelch opened without a synchronization symbol
+	uint32_t getEmptyFrames()
+	{
+		return empty_frames;
+	}
+
+	//! Number of frames replayed through the decoder
+	uint32_t getDecodedFrames()
+	{
+		return decoded_frames;
+	}
+
+	//! Time from the end of the capture to the end of the decoding of the last frame
+	int getLastLatencyMs()
+	{
+		return ms(last_latency);
+	}
+
+	int getMaxLatencyMs()
+	{
+		return ms(max_latency);
+	}
+
+	int getMeanLatencyMs()
+	{
+		return decoded_frames ? ms(sum_latency / decoded_frames) : 0;
+	}
+
+	//! Noise floor of the squelch, in the units of the correlator power estimate
+	value getNoiseFloor()
+	{
+		return squelch.getFloor();
+	}
+
+	//! Profile of the front end, the back end uses getDecoder().getProfile()
+	Profile &getFrontProfile()
+	{
+		return front_profile;
+	}
+};
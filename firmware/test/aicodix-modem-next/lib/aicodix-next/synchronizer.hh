@@ -0,0 +1,186 @@
+/**
+ * @file synchronizer.hh
+ * @brief Front end of the OFDM decoder: DC blocker, Hilbert filter, sample history and Schmidl-Cox correlator
+ * 	- Works on blocks of extended_len samples, like Decoder::feed()
+ * 	- Reports the detected synchronization symbol of each block as a Detection
+ * 	- With an input_rate above the rate, a DSP::Decimator brings the samples of the codec down first
+ * @note The Decoder runs one internally.  The RxPipeline runs a second one on another core and hands
+ * 	the detections over, so the Decoder can skip the correlator, see rx_pipeline.hh.
+ *
+ * @copyright Copyright (c) 2024
+ */
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "schmidl_cox.hh"
+#include "bip_buffer.hh"
+#include "blockdc.hh"
+#include "hilbert.hh"
+#include "mls.hh"
+#include "profile.hh"
+#include "decimator.hh"
+
+//! Synchronization symbol found in a block, the same for every input_rate
+template <typename value>
+struct SyncDetection
+{
+	value cfo_rad = 0;
+	// Position of the metadata symbol, relative to buffer() of the block
+	int position = 0;
+	bool check = false;
+};
+
+/**
+ * @tparam input_rate rate of the samples passed to operator(), a multiple of rate, e.g. 48000 for the codec.
+ * 	The decimator has 16 taps per output sample, 16 multiply-adds per input sample.
+ */
+template <typename value, typename cmplx, int rate, int input_rate = rate>
+class Synchronizer
+{
+	static_assert(input_rate % rate == 0, "input_rate not a multiple of rate");
+public:
+	static const int factor = input_rate / rate;
+	typedef DSP::Decimator<value, factor, 16 * factor> decimator_type;
+	static const int symbol_len = (1280 * rate) / 8000;
+	static const int filter_len = (((21 * rate) / 8000) & ~3) | 1;
+	static const int guard_len = symbol_len / 8;
+	static const int extended_len = symbol_len + guard_len;
+	// Input samples per block
+	static const int input_len = factor * extended_len;
+	static const int buffer_len = 4 * extended_len;
+	static const int search_pos = extended_len;
+	static const int mls0_len = 127;
+	static const int mls0_off = - mls0_len + 1;
+	static const int mls0_poly = 0b10001001;
+
+	typedef SyncDetection<value> Detection;
+
+private:
+	decimator_type decimator;
+	int16_t decimated[factor > 1 ? extended_len : 1];
+	const int16_t *last = nullptr;
+	int last_count = 0;
+	DSP::BlockDC<value, value> blockdc;
+	DSP::Hilbert<cmplx, filter_len> hilbert;
+	DSP::BipBuffer<cmplx, buffer_len> input_hist;
+	SchmidlCox<value, cmplx, search_pos, symbol_len/2, guard_len> correlator;
+	Profile &profile;
+	Detection stored, staged;
+	int accumulated = 0;
+	// Blocks left until the history holds no samples from before the last reset()
+	int holdoff = 0;
+	const cmplx *buf = nullptr;
+
+	static const cmplx *mls0_seq(cmplx *fdom)
+	{
+		CODE::MLS seq0(mls0_poly);
+		for (int i = 0; i < symbol_len/2; ++i)
+			fdom[i] = 0;
+		for (int i = 0; i < mls0_len; ++i)
+			fdom[(i+mls0_off/2+symbol_len/2)%(symbol_len/2)] = 1 - 2 * seq0();
+		return fdom;
+	}
+
+	bool correlate(const cmplx *samples)
+	{
+		PROFILE_SCOPE(profile, CORRELATOR);
+		return correlator(samples);
+	}
+
+public:
+	// The kernel of the correlator is built in a temporary buffer, it is only needed during construction
+	Synchronizer(Profile &profile) : correlator(mls0_seq(std::vector<cmplx>(symbol_len/2).data())), profile(profile)
+	{
+		blockdc.samples(filter_len);
+	}
+
+	/**
+	 * @brief Run audio samples through the front end
+	 * @param samples mono 16-bit audio samples at input_rate
+	 * @param count number of samples, at most input_len
+	 * @param correlate false leaves out the correlator, when the detections come from another Synchronizer
+	 * @return true when a block of extended_len samples is complete, see buffer() and detection()
+	 */
+	bool operator()(const int16_t *samples, int count, bool correlate = true)
+	{
+		PROFILE_SCOPE(profile, FEED);
+		assert(count <= input_len);
+		if constexpr (factor > 1) {
+			count = decimator(decimated, samples, count);
+			samples = decimated;
+		}
+		last = samples;
+		last_count = count;
+		for (int i = 0; i < count; ++i) {
+			const cmplx *hist = input_hist(hilbert(blockdc(samples[i])));
+			if (correlate && this->correlate(hist)) {
+				profile.count(Profile::SYNC_DETECT);
+				stored.cfo_rad = correlator.cfo_rad;
+				stored.position = correlator.symbol_pos + accumulated + 1;
+				stored.check = true;
+			}
+			if (++accumulated == extended_len)
+				buf = input_hist();
+		}
+		if (accumulated >= extended_len) {
+			accumulated -= extended_len;
+			staged = stored;
+			stored.check = false;
+			if (holdoff) {
+				--holdoff;
+				staged.check = false;
+			}
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	 * @brief Samples of the last call at rate, after the decimator
+	 * @note Only valid until the next call, and with a factor of one they are still the samples of the caller.
+	 * 	Fed input_len samples at a time, these are the samples of the whole block.
+	 */
+	const int16_t *samples(int *count)
+	{
+		*count = last_count;
+		return last;
+	}
+
+	//! Sample history at the end of the last complete block, buffer_len samples
+	const cmplx *buffer()
+	{
+		return buf;
+	}
+
+	//! Power estimate of the correlator, half the energy of the last two symbols
+	value power()
+	{
+		return correlator.power;
+	}
+
+	//! Synchronization symbol found in the last complete block, if check is set
+	const Detection &detection()
+	{
+		return staged;
+	}
+
+	/**
+	 * @brief Start over after a gap in the samples
+	 * @note The history and the windows of the correlator still hold samples from before the gap,
+	 * 	so no detections are reported for the next buffer_len samples.
+	 */
+	void reset()
+	{
+		stored.check = false;
+		staged.check = false;
+		holdoff = buffer_len / extended_len;
+	}
+
+	//! False while the history still holds samples from before the last reset()
+	bool settled()
+	{
+		return !holdoff;
+	}
+};
@@ -34,6 +34,17 @@ public:
 		y_ ^= y_ << 5;
 		return y_;
 	}
+	// Inverse of operator(), returns the previous number of the sequence
+	uint32_t prev()
+	{
+		y_ ^= y_ << 5;
+		y_ ^= y_ << 10;
+		y_ ^= y_ << 20;
+		y_ ^= y_ >> 17;
+		y_ ^= y_ << 13;
+		y_ ^= y_ << 26;
+		return y_;
+	}
 };
 
 class Xorshift64
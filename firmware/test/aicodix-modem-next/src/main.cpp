@@ -7,43 +7,33 @@
  *
  * @copyright Copyright (c) 2024
  * @note
- * 	- When not adding a synchronization symbol, before every packet, the Es/N0 will drop at each packet, resulting in a packet loss after a few packets.
+ * 	- The message is sent in bursts: one synchronization and metadata symbol, followed by up to Encoder::getBurstMax() packets.
+ * 	  The metadata carries the number of packets, the decoder keeps tracking the phase and the sample rate offset over the whole burst.
+ * 	- LinkAdaptation keeps the Es/N0 of the frames of each peer and chooses the mode to reply with.
  */
 
 #include <Arduino.h>
 #include "encode.hh"
 #include "decode.hh"
+#include "link_adaptation.hh"
 #include "modem_config.hh"
-#include <queue>
+#include <vector>
 
 typedef float value;
 typedef DSP::Complex<value> cmplx;
 
 static Encoder<value, cmplx, 8000> *encoder = nullptr;
 static Decoder<value, cmplx, 8000> *decoder = nullptr;
+// Operating mode for each peer, from the Es/N0 of its frames
+static LinkAdaptation<value> link_adaptation;
 static const char *TAG = "main";
-std::queue<int16_t> sampleQueue;
+std::vector<int16_t> sampleBuffer;
 
 void sampleSink(int16_t samples[], int count)
 {
 	// ESP_LOGI(TAG, "sampleSink: %d", count);
-	for (int i = 0; i < count; i++)
-	{
-		sampleQueue.push(samples[i]);
-	}
-	// ESP_LOGI(TAG, "sampleQueue: %d", sampleQueue.size());
-}
-
-bool sampleSource(int16_t *sample)
-{
-	if (sampleQueue.empty())
-	{
-		*sample = 0; // Dummy value
-		return false;
-	}
-	*sample = sampleQueue.front();
-	sampleQueue.pop();
-	return true;
+	sampleBuffer.insert(sampleBuffer.end(), samples, samples + count);
+	// ESP_LOGI(TAG, "sampleBuffer: %d", sampleBuffer.size());
 }
 
 void setup()
@@ -56,8 +46,7 @@ void setup()
 	encoder = new Encoder<value, cmplx, 8000>();
 	decoder = new Decoder<value, cmplx, 8000>();
 	encoder->setSampleSink(sampleSink);
-	decoder->setSampleSource(sampleSource);
-	uint64_t call_sign = 1, rx_call_sign = 0;
+	uint64_t call_sign = 1;
 	const modem_config_t *modem_config = &modem_configs[11];
 	encoder->configure(1600, modem_config);
 
@@ -84,40 +73,55 @@ void setup()
 	//  Payload
 	ESP_LOGI(TAG, "Creating payload block");
 	
-	int packet_size = encoder->getPacketSize();
-	for (uint8_t *ptr = msg; ptr < msg + sizeof(msg); ptr += packet_size)
-	{
-		encoder->synchronization_symbol();
-		encoder->metadata_symbol(call_sign);
-		encoder->data_packet(ptr, packet_size);
-	}
-	// End of the transmission
+	encoder->burst(call_sign, msg, sizeof(msg));
+	// End of the transmission, flushes the last payload symbol through the decoder
 	// ESP_LOGI(TAG, "Creating tail block");
-	// encoder->silence_packet();
+	encoder->silence_packet();
 	// ESP_LOGI(TAG, "Time to build a packet: %d ms", millis() - startTime);
 
 	// Start of the reception
 	
-	uint8_t *dec_msg = nullptr;
-	int len;
+	uint8_t dec_msg[1024];
+	int block_len = decoder->getExtendedLen();
 	startTime = millis();
-	while (decoder->synchronization_symbol())
+	for (size_t i = 0; i + block_len <= sampleBuffer.size(); i += block_len)
 	{
-		if (!decoder->metadata_symbol(rx_call_sign))
+		if (!decoder->feed(&sampleBuffer[i], block_len))
+			continue;
+		int status = decoder->process();
+		if (status == STATUS_FAIL || status == STATUS_NOPE)
 		{
 			ESP_LOGE(TAG, "Metadata not detected");
-			return;
+			continue;
 		}
-		ESP_LOGI(TAG, "Metadata: %lu", rx_call_sign);
-		if (decoder->data_packet(&dec_msg, len))
+		if (status != STATUS_DONE)
+			continue;
+		value cfo;
+		int mode;
+		uint64_t rx_call_sign;
+		decoder->staged(&cfo, &mode, &rx_call_sign);
+		ESP_LOGI(TAG, "Metadata: %llu, mode: %d, cfo: %.1f Hz, block %d of %d", rx_call_sign, mode, cfo, decoder->getBlockNumber() + 1, decoder->getBurstBlocks());
+		link_adaptation.update(rx_call_sign, mode, decoder->getEsN0());
+		ESP_LOGI(TAG, "Es/N0: %.1f dB, SNR estimate: %.1f dB, mode for the reply: %d", decoder->getEsN0(), link_adaptation.getSnr(rx_call_sign), link_adaptation.getMode(rx_call_sign));
+		int len = decoder->fetch(dec_msg);
+		if (len > 0)
 		{
 			dec_msg[len - 1] = '\0';
 			ESP_LOGI(TAG, "Message: %s, length: %d", dec_msg, len);
 		}
 		ESP_LOGI(TAG, "Time to receive a packet: %d ms", millis() - startTime);
+		for (int step = 0; step < decoder->getListSteps(); step++)
+			ESP_LOGI(TAG, "List size %d: %d packets", decoder->getListSize(step), decoder->getListOkay(step));
+		ESP_LOGI(TAG, "List decoding failed: %d packets", decoder->getListFail());
+		ESP_LOGI(TAG, "Decoder arena: %d of %d bytes used", decoder->getArenaHighWater(), decoder->getArenaSize());
+#ifdef MODEM_PROFILE
+		decoder->getProfile().dump(std::cerr);
+		std::cerr << std::endl;
+		decoder->getProfile().reset();
+#endif
 		startTime = millis();
 	}
-	
+	sampleBuffer.clear();
 }
 
 void loop()
@@ -7,6 +7,7 @@ Copyright 2022 Ahmet Inan <inan@aicodix.de>
 #pragma once
 
 #include <cmath>
+#include <cassert>
 #include <iostream>
 #include <algorithm>
 #include <cstring>
@@ -16,6 +17,7 @@ namespace DSP { using std::abs; using std::min; using std::cos; using std::sin;
 #include "schmidl_cox.hh"
 #include "bip_buffer.hh"
 #include "theil_sen.hh"
+#include "repeated_median.hh"
 #include "xorshift.hh"
 #include "decibel.hh"
 #include "complex.hh"
@@ -30,6 +32,7 @@ namespace DSP { using std::abs; using std::min; using std::cos; using std::sin;
 #include "image.hh"
 #include "polar.hh"
 #include "fft.hh"
+#include "shared_table.hh"
 #include "mls.hh"
 #include "crc.hh"
 #include "osd.hh"
@@ -59,7 +62,8 @@ struct DecoderInterface {
 	virtual ~DecoderInterface() = default;
 };
 
-template<int RATE>
+// SlopeEstimator: DSP::TheilSenEstimator needs O(n²) memory (130 KB), DSP::RepeatedMedianEstimator only O(n)
+template<int RATE, template<typename, int> class SlopeEstimator = DSP::TheilSenEstimator>
 class Decoder : public DecoderInterface {
 	typedef DSP::Complex<float> cmplx;
 	typedef DSP::Const<float> Const;
@@ -93,7 +97,7 @@ class Decoder : public DecoderInterface {
 	DSP::BlockDC<float, float> block_dc;
 	DSP::Hilbert<cmplx, filter_length> hilbert;
 	DSP::BipBuffer<cmplx, buffer_length> buffer;
-	DSP::TheilSenEstimator<float, pay_car_cnt> tse;
+	SlopeEstimator<float, pay_car_cnt> tse;
 	DSP::Phasor<cmplx> osc;
 	DSP::Hann<float> hann;
 	DSP::LowPass2<float> lowpass;
@@ -104,7 +108,22 @@ class Decoder : public DecoderInterface {
 	cmplx temp[extended_length], freq[symbol_length], prev[pay_car_cnt], cons[pay_car_cnt];
 	float power[spectrum_width]{}, index[pay_car_cnt]{}, phase[pay_car_cnt]{};
 	code_type code[code_len];
-	int8_t generator[255 * 71];
+	// The BCH generator matrix is immutable and shared by all decoders
+	struct GeneratorMatrix {
+		int8_t generator[255 * 71];
+
+		GeneratorMatrix() {
+			CODE::BoseChaudhuriHocquenghemGenerator<255, 71>::matrix(generator, true, {
+				0b100011101, 0b101110111, 0b111110011, 0b101101001,
+				0b110111101, 0b111100111, 0b100101011, 0b111010111,
+				0b000010011, 0b101100101, 0b110001011, 0b101100011,
+				0b100011011, 0b100111111, 0b110001101, 0b100101101,
+				0b101011111, 0b111111001, 0b111000011, 0b100111001,
+				0b110101001, 0b000011111, 0b110000111, 0b110110001});
+		}
+	};
+
+	SharedTable<GeneratorMatrix> generator;
 	int8_t soft[pre_seq_len];
 	uint8_t data[(pre_seq_len + 7) / 8];
 	int symbol_number = symbol_count;
@@ -270,7 +289,7 @@ class Decoder : public DecoderInterface {
 			freq[bin(i + pre_seq_off)] *= nrz(seq());
 		for (int i = 0; i < pre_seq_len; ++i)
 			PhaseShiftKeying<2, cmplx, int8_t>::soft(soft + i, demod_or_erase(freq[bin(i + pre_seq_off)], freq[bin(i - 1 + pre_seq_off)]), 32);
-		if (!osd(data, soft, generator))
+		if (!osd(data, soft, generator->generator))
 			return STATUS_FAIL;
 		uint64_t md = 0;
 		for (int i = 0; i < 55; ++i)
@@ -296,13 +315,6 @@ class Decoder : public DecoderInterface {
 
 public:
 	Decoder() : correlator(corSeq()), crc(0xA8F4), lowpass(1, symbol_length), window(&hann, &lowpass) {
-		CODE::BoseChaudhuriHocquenghemGenerator<255, 71>::matrix(generator, true, {
-			0b100011101, 0b101110111, 0b111110011, 0b101101001,
-			0b110111101, 0b111100111, 0b100101011, 0b111010111,
-			0b000010011, 0b101100101, 0b110001011, 0b101100011,
-			0b100011011, 0b100111111, 0b110001101, 0b100101101,
-			0b101011111, 0b111111001, 0b111000011, 0b100111001,
-			0b110101001, 0b000011111, 0b110000111, 0b110110001});
 		block_dc.samples(filter_length);
 		osc.omega(-2000, RATE);
 	}
@@ -7,7 +7,9 @@ Copyright 2022 Ahmet Inan <inan@aicodix.de>
 #pragma once
 
 #include <cmath>
+#include <cassert>
 #include <iostream>
+#include <algorithm>
 #include "bose_chaudhuri_hocquenghem_encoder.hh"
 #include "base37_bitmap.hh"
 #include "xorshift.hh"
@@ -17,7 +17,9 @@ struct PolarListNode
 	typedef PolarHelper<TYPE> PH;
 	typedef typename PH::PATH PATH;
 	typedef typename PH::MAP MAP;
+	typedef typename TYPE::value_type VALUE;
 	static const int N = 1 << M;
+	enum { OTHER, RATE0, RATE1, REP, SPC };
 	static MAP rate0(PATH *metric, TYPE *hard, TYPE *soft)
 	{
 		for (int i = 0; i < N; ++i)
@@ -31,6 +33,258 @@ struct PolarListNode
 			map.v[k] = k;
 		return map;
 	}
+	static int kind(uint32_t frozen)
+	{
+		static_assert(N <= 32);
+		const uint32_t mask = N == 32 ? 0xffffffff : (1U << (N & 31)) - 1;
+		if (frozen == mask)
+			return RATE0;
+		if (frozen == 0)
+			return RATE1;
+		if (frozen == mask >> 1)
+			return REP;
+		if (frozen == 1)
+			return SPC;
+		return OTHER;
+	}
+	static int kind(const uint32_t *frozen)
+	{
+		static_assert(N >= 64);
+		const int W = N / 32;
+		bool zero = true, ones = true;
+		for (int i = 1; i < W-1; ++i) {
+			zero = zero && frozen[i] == 0;
+			ones = ones && frozen[i] == 0xffffffff;
+		}
+		if (ones && frozen[0] == 0xffffffff && frozen[W-1] == 0xffffffff)
+			return RATE0;
+		if (zero && frozen[0] == 0 && frozen[W-1] == 0)
+			return RATE1;
+		if (ones && frozen[0] == 0xffffffff && frozen[W-1] == 0x7fffffff)
+			return REP;
+		if (zero && frozen[0] == 1 && frozen[W-1] == 0)
+			return SPC;
+		return OTHER;
+	}
+	// Emits the message bits of the codeword in hard from bit first on, the paths forked before the first
+	static void emit(TYPE *message, MAP *maps, int *count, TYPE *hard, TYPE *soft, MAP map, int first)
+	{
+		// The lower half of soft is not used by this node, reuse it for the message bits
+		TYPE *mesg = soft;
+		for (int i = 0; i < N; ++i)
+			mesg[i] = hard[i];
+		for (int h = 1; h < N; h *= 2)
+			for (int i = 0; i < N; i += 2 * h)
+				for (int j = i; j < i + h; ++j)
+					mesg[j] = PH::qmul(mesg[j], mesg[j+h]);
+		MAP same;
+		for (int k = 0; k < TYPE::SIZE; ++k)
+			same.v[k] = k;
+		for (int i = first; i < N; ++i) {
+			message[*count] = mesg[i];
+			maps[*count] = i == first ? map : same;
+			++*count;
+		}
+	}
+	/*
+	The L best of the paths, either kept with the metric keep[k] or forked
+	with flip[k], in ascending order: perm[k] is 2*path+forked, best[k]
+	its metric.  Only the forks better than the worst kept path can make
+	it, they are sorted and merged with the sorted kept paths.
+	*/
+	static void select(int *perm, PATH *best, const PATH *keep, const PATH *flip)
+	{
+		const int L = TYPE::SIZE;
+		int kept[L], forked[L], order[L];
+		PATH keep_sorted[L], flip_sorted[L];
+		for (int k = 0; k < L; ++k)
+			keep_sorted[k] = keep[k];
+		CODE::insertion_sort(kept, keep_sorted, L);
+		int n = 0;
+		for (int k = 0; k < L; ++k) {
+			if (flip[k] < keep_sorted[L-1]) {
+				flip_sorted[n] = flip[k];
+				forked[n++] = k;
+			}
+		}
+		if (n)
+			CODE::insertion_sort(order, flip_sorted, n);
+		for (int k = 0, i = 0, j = 0; k < L; ++k) {
+			if (j < n && flip_sorted[j] < keep_sorted[i]) {
+				perm[k] = 2 * forked[order[j]] + 1;
+				best[k] = flip_sorted[j++];
+			} else {
+				perm[k] = 2 * kept[i];
+				best[k] = keep_sorted[i++];
+			}
+		}
+	}
+	/*
+	Fast-SSCL decoding of rate-1, repetition and single parity check nodes
+	for lists (TYPE::SIZE > 1), after Hashemi, Condo and Gross: "Fast and
+	Flexible Successive-Cancellation List Decoders for Polar Codes".
+	Repetition: every path forks into all zeros and all ones.
+	Rate-1: starting from the hard decisions, the paths fork on flipping
+	their L-1 least reliable bits, one after the other.
+	SPC: the least reliable bit fixes the parity of the hard decisions,
+	then the paths fork on flipping each of their next least reliable bits
+	together with the least reliable one.
+	A flip adds the magnitude of the LLR to the path metric, or takes it
+	off again, when the bit was already flipped.
+	The forks only approximate the bitwise list: the surviving paths can
+	differ from it, without a measurable change of the frame error rate.
+	*/
+	static MAP list(int kind, PATH *metric, TYPE *message, MAP *maps, int *count, TYPE *hard, TYPE *soft)
+	{
+		const int L = TYPE::SIZE;
+		const int W = L < N ? L : N;
+		PATH keep[L], flip[L];
+		int perm[L];
+		MAP map;
+		if (kind == REP) {
+			for (int k = 0; k < L; ++k)
+				keep[k] = flip[k] = metric[k];
+			for (int i = 0; i < N; ++i) {
+				for (int k = 0; k < L; ++k) {
+					int llr = soft[i+N].v[k];
+					if (llr < 0)
+						keep[k] -= llr;
+					else
+						flip[k] += llr;
+				}
+			}
+			select(perm, metric, keep, flip);
+			for (int k = 0; k < L; ++k)
+				map.v[k] = perm[k] >> 1;
+			for (int i = 0; i < N; ++i)
+				for (int k = 0; k < L; ++k)
+					hard[i].v[k] = 1 - 2 * (perm[k] & 1);
+			emit(message, maps, count, hard, soft, map, N-1);
+			return map;
+		}
+		// The W least reliable bits of each lane, the least reliable first: positions and magnitudes
+		int least[L][W], mags[L][W];
+		for (int k = 0; k < L; ++k) {
+			for (int i = 0, n = 0; i < N; ++i) {
+				int mag = std::abs(int(soft[i+N].v[k]));
+				if (n == W && mag >= mags[k][W-1])
+					continue;
+				int j = n < W ? n++ : W-1;
+				for (; j > 0 && mag < mags[k][j-1]; --j) {
+					least[k][j] = least[k][j-1];
+					mags[k][j] = mags[k][j-1];
+				}
+				least[k][j] = i;
+				mags[k][j] = mag;
+			}
+		}
+		// Lane of each path before the node and its flipped bits, bit j for least[origin][j]
+		int origin[L], prev_origin[L];
+		uint32_t flips[L], prev_flips[L];
+		for (int k = 0; k < L; ++k) {
+			origin[k] = k;
+			flips[k] = 0;
+		}
+		int first = 0, steps = L-1 < N ? L-1 : N;
+		if (kind == SPC) {
+			for (int k = 0; k < L; ++k) {
+				bool odd = false;
+				for (int i = 0; i < N; ++i)
+					odd ^= soft[i+N].v[k] < 0;
+				if (odd) {
+					flips[k] = 1;
+					metric[k] += mags[k][0];
+				}
+			}
+			first = 1;
+			steps = W;
+		}
+		for (int t = first; t < steps; ++t) {
+			uint32_t bits = (1U << t) | (kind == SPC);
+			for (int k = 0; k < L; ++k) {
+				keep[k] = flip[k] = metric[k];
+				flip[k] += mags[origin[k]][t];
+				if (kind == SPC)
+					flip[k] += flips[k] & 1 ? -mags[origin[k]][0] : mags[origin[k]][0];
+			}
+			select(perm, metric, keep, flip);
+			for (int k = 0; k < L; ++k) {
+				prev_origin[k] = origin[k];
+				prev_flips[k] = flips[k];
+			}
+			for (int k = 0; k < L; ++k) {
+				origin[k] = prev_origin[perm[k]>>1];
+				flips[k] = prev_flips[perm[k]>>1] ^ (perm[k] & 1 ? bits : 0);
+			}
+		}
+		for (int i = 0; i < N; ++i)
+			for (int k = 0; k < L; ++k)
+				hard[i].v[k] = 1 - 2 * (soft[i+N].v[origin[k]] < 0);
+		for (int k = 0; k < L; ++k)
+			for (int j = 0; j < W; ++j)
+				if ((flips[k] >> j) & 1)
+					hard[least[origin[k]][j]].v[k] *= -1;
+		for (int k = 0; k < L; ++k)
+			map.v[k] = origin[k];
+		emit(message, maps, count, hard, soft, map, first);
+		return map;
+	}
+	/*
+	Fast-SSC decoding of rate-1, repetition and single parity check nodes
+	for successive cancellation (TYPE::SIZE == 1)
+	*/
+	static void fast(int kind, TYPE *message, MAP *maps, int *count, TYPE *hard, TYPE *soft)
+	{
+		int first = 0;
+		if (kind == REP) {
+			int sum = 0;
+			for (int i = 0; i < N; ++i)
+				sum += soft[i+N].v[0];
+			for (int i = 0; i < N; ++i)
+				hard[i].v[0] = 1 - 2 * (sum < 0);
+			first = N-1;
+		} else {
+			for (int i = 0; i < N; ++i)
+				hard[i].v[0] = 1 - 2 * (soft[i+N].v[0] < 0);
+			if (kind == SPC) {
+				int worst = 0;
+				VALUE check = 1;
+				for (int i = 0; i < N; ++i) {
+					check *= hard[i].v[0];
+					if (std::abs(int(soft[i+N].v[0])) < std::abs(int(soft[worst+N].v[0])))
+						worst = i;
+				}
+				hard[worst].v[0] *= check;
+				first = 1;
+			}
+		}
+		MAP map;
+		map.v[0] = 0;
+		emit(message, maps, count, hard, soft, map, first);
+	}
+	/*
+	Decodes rate-0, rate-1, repetition and single parity check nodes in
+	one step, fast() for successive cancellation and list() for lists.
+	Returns false when the node has to be decoded bit by bit.
+	*/
+	template <typename FROZEN>
+	static bool special(MAP *map, PATH *metric, TYPE *message, MAP *maps, int *count, TYPE *hard, TYPE *soft, FROZEN frozen)
+	{
+		int type = kind(frozen);
+		if (type == RATE0) {
+			*map = rate0(metric, hard, soft);
+			return true;
+		}
+		if (type == OTHER)
+			return false;
+		if constexpr (TYPE::SIZE == 1) {
+			fast(type, message, maps, count, hard, soft);
+			map->v[0] = 0;
+		} else {
+			*map = list(type, metric, message, maps, count, hard, soft);
+		}
+		return true;
+	}
 };
 
 template <typename TYPE>
@@ -88,6 +342,9 @@ struct PolarListTree
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *count, TYPE *hard, TYPE *soft, const uint32_t *frozen)
 	{
+		MAP map;
+		if (PolarListNode<TYPE, M>::special(&map, metric, message, maps, count, hard, soft, frozen))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
 		MAP lmap = PolarListTree<TYPE, M-1>::decode(metric, message, maps, count, hard, soft, frozen);
@@ -110,6 +367,9 @@ struct PolarListTree<TYPE, 6>
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *count, TYPE *hard, TYPE *soft, const uint32_t *frozen)
 	{
+		MAP map;
+		if (PolarListNode<TYPE, M>::special(&map, metric, message, maps, count, hard, soft, frozen))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
 		MAP lmap, rmap;
@@ -139,6 +399,9 @@ struct PolarListTree<TYPE, 5>
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *count, TYPE *hard, TYPE *soft, uint32_t frozen)
 	{
+		MAP map;
+		if (PolarListNode<TYPE, M>::special(&map, metric, message, maps, count, hard, soft, frozen))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
 		MAP lmap, rmap;
@@ -168,6 +431,9 @@ struct PolarListTree<TYPE, 4>
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *count, TYPE *hard, TYPE *soft, uint32_t frozen)
 	{
+		MAP map;
+		if (PolarListNode<TYPE, M>::special(&map, metric, message, maps, count, hard, soft, frozen))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
 		MAP lmap, rmap;
@@ -197,6 +463,9 @@ struct PolarListTree<TYPE, 3>
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *count, TYPE *hard, TYPE *soft, uint32_t frozen)
 	{
+		MAP map;
+		if (PolarListNode<TYPE, M>::special(&map, metric, message, maps, count, hard, soft, frozen))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
 		MAP lmap, rmap;
@@ -226,6 +495,9 @@ struct PolarListTree<TYPE, 2>
 	static const int N = 1 << M;
 	static MAP decode(PATH *metric, TYPE *message, MAP *maps, int *count, TYPE *hard, TYPE *soft, uint32_t frozen)
 	{
+		MAP map;
+		if (PolarListNode<TYPE, M>::special(&map, metric, message, maps, count, hard, soft, frozen))
+			return map;
 		for (int i = 0; i < N/2; ++i)
 			soft[i+N/2] = PH::prod(soft[i+N], soft[i+N/2+N]);
 		MAP lmap, rmap;
@@ -0,0 +1,109 @@
+/*
+Immutable tables shared by all instances of a class
+
+The first instance allocates and builds the table, the others only
+count themselves in, and the last one frees it again.  The table lives
+on the heap, in PSRAM on the ESP32 when available.  A static table
+would land in .bss, which takes internal RAM even while no instance
+exists.
+*/
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#if defined(ESP32) && defined(BOARD_HAS_PSRAM)
+#include "esp_heap_caps.h"
+#endif
+
+class SharedTables
+{
+protected:
+	static std::mutex &mutex()
+	{
+		static std::mutex lock;
+		return lock;
+	}
+	static size_t &total()
+	{
+		static size_t count;
+		return count;
+	}
+	static void *allocate(size_t count)
+	{
+#if defined(ESP32) && defined(BOARD_HAS_PSRAM)
+		void *ptr = heap_caps_malloc(count, MALLOC_CAP_SPIRAM);
+#else
+		void *ptr = ::operator new(count);
+#endif
+		assert(ptr);
+		total() += count;
+		return ptr;
+	}
+	static void release(void *ptr, size_t count)
+	{
+#if defined(ESP32) && defined(BOARD_HAS_PSRAM)
+		heap_caps_free(ptr);
+#else
+		::operator delete(ptr);
+#endif
+		total() -= count;
+	}
+public:
+	//! Bytes taken by all the shared tables allocated at the moment
+	static size_t bytes()
+	{
+		std::lock_guard<std::mutex> guard(mutex());
+		return total();
+	}
+};
+
+template <typename TABLE>
+class SharedTable : public SharedTables
+{
+	static_assert(alignof(TABLE) <= alignof(std::max_align_t), "table alignment too large for the heap");
+	static TABLE *&table()
+	{
+		static TABLE *ptr;
+		return ptr;
+	}
+	static int &users()
+	{
+		static int count;
+		return count;
+	}
+	static const TABLE *acquire()
+	{
+		std::lock_guard<std::mutex> guard(mutex());
+		if (!users()++)
+			table() = new (allocate(sizeof(TABLE))) TABLE;
+		return table();
+	}
+	const TABLE *ptr;
+public:
+	SharedTable() : ptr(acquire())
+	{
+	}
+	SharedTable(const SharedTable &) : ptr(acquire())
+	{
+	}
+	SharedTable &operator=(const SharedTable &)
+	{
+		return *this;
+	}
+	~SharedTable()
+	{
+		std::lock_guard<std::mutex> guard(mutex());
+		if (!--users()) {
+			table()->~TABLE();
+			release(table(), sizeof(TABLE));
+			table() = nullptr;
+		}
+	}
+	const TABLE *operator->() const
+	{
+		return ptr;
+	}
+};
@@ -41,7 +41,6 @@ I2SAudio::~I2SAudio()
     delete m_output;
     delete m_input;
     vQueueDelete(m_sample_sink);
-    vQueueDelete(m_sample_source);
 }
 
 /**
@@ -78,20 +77,15 @@ void I2SAudio::start_output(std::size_t maxMessages)
 
 /**
  * @brief Start the I2S input task
- *
- * @param adc_sample_queue Queue of samples to be received from the ADC input
+ * @note The task writes the samples of each channel into a lock-free ring, see getSourceSamples()
  */
-void I2SAudio::start_input(std::size_t maxMessages)
+void I2SAudio::start_input()
 {
     if (!m_input)
     {
         m_input = new I2SInput(m_i2sPort, &m_i2s_pin_config);
     }
-    if (!m_sample_source)
-    {
-        m_sample_source = xQueueCreate(maxMessages, sizeof(BufferSyncMessage));
-    }
-    m_input->start(m_sample_source);
+    m_input->start(&m_left_samples, &m_right_samples);
 }
 
 /**
@@ -157,95 +151,87 @@ bool I2SAudio::addRawSinkSamples(uint8_t samples[], int count)
     return xQueueSend(m_sample_sink, &message, portMAX_DELAY) == pdTRUE;
 }
 
+SampleRing *I2SAudio::sourceRing(AudioChannel channel)
+{
+    switch (channel)
+    {
+    case AudioChannel::LEFT:
+        return &m_left_samples;
+    case AudioChannel::RIGHT:
+        return &m_right_samples;
+    default:
+        return nullptr;
+    }
+}
+
 /**
- * @brief Get samples from the I2S input queue
+ * @brief Get samples from the I2S input ring
  *
  * @param samples Pointer to the array of channel samples
  * @param sample_count Number of samples
  *  Upon calling this function, sample_count should contain the maximum number of samples that can be stored in samples[].
  *  Upon return, sample_count will contain the actual number of samples stored in samples[].
- * @return true if the desired number of samples were read from the queue
+ *  Waits until at least one sample is available, but returns what is there instead of waiting for all of them.
+ * @return false for AudioChannel::BOTH
  */
 bool I2SAudio::getSourceSamples(int16_t samples[], size_t &sample_count, AudioChannel channel)
 {
-    size_t samples_read = 0;
-    std::queue<int16_t>* queue = nullptr;
-
-    switch(channel)
+    SampleRing *ring = sourceRing(channel);
+    if (!ring)
     {
-        case AudioChannel::LEFT:
-            queue = &m_left_samples;
-            break;
-        case AudioChannel::RIGHT:
-            queue = &m_right_samples;
-            break;
-        case AudioChannel::BOTH:
-            return false;
+        return false;
     }
-
-    while (samples_read < sample_count)
+    size_t samples_read = ring->read(samples, sample_count);
+    while (samples_read == 0 && sample_count > 0)
     {
-        if (!queue->empty())
-        {
-            samples[samples_read] = queue->front();
-            queue->pop();
-            samples_read++;
-        }
-        else
-        {
-            if (!fillSampleQueue())
-            {
-                break;
-            }
-        }
+        vTaskDelay(1);
+        samples_read = ring->read(samples, sample_count);
     }
     sample_count = samples_read;
     return true;
 }
 
+/**
+ * @brief Get interleaved left and right samples from the I2S input rings
+ *
+ * @param samples Pointer to the array receiving up to SAMPLE_BUFFER_SIZE bytes
+ * @param byte_count Upon return, the number of bytes stored in samples[]
+ */
 void I2SAudio::getRawSourceSamples(uint8_t samples[], size_t &byte_count)
 {
-    BufferSyncMessage message;
-    byte_count = 0;
-    if (xQueueReceive(m_sample_source, &message, portMAX_DELAY) == pdTRUE)
-    {
-        mempcpy(samples, message.data, message.size);
-        byte_count = message.size;
-    }
-}
-
-bool I2SAudio::fillSampleQueue()
-{
-    const size_t MAX_QUEUE_SIZE = 256;
-    BufferSyncMessage message;
-    int16_t *samples = nullptr;
-    getRawSourceSamples(message.data, message.size);
-    if (message.size == 0)
-    {
-        return false;
-    }
-    samples = reinterpret_cast<int16_t *>(message.data);
-    size_t total_sample_count = message.size / sizeof(int16_t); // total number of samples for left + right channels
-    for (int i = 0; i < total_sample_count; i++)
+    const size_t MAX_FRAMES = SAMPLE_BUFFER_SIZE / (2 * sizeof(int16_t));
+    int16_t left[MAX_FRAMES], right[MAX_FRAMES];
+    size_t frame_count = 0;
+    while (frame_count == 0)
     {
-        if (i % 2 == 0)
+        size_t left_count = m_left_samples.available();
+        size_t right_count = m_right_samples.available();
+        frame_count = left_count < right_count ? left_count : right_count;
+        if (frame_count > MAX_FRAMES)
         {
-            // Even samples = left channel
-            if (m_left_samples.size() >= MAX_QUEUE_SIZE)
-            {
-                m_left_samples.pop(); // remove the oldest sample
-            }
-            m_left_samples.push(samples[i]);
+            frame_count = MAX_FRAMES;
         }
-        else
+        if (frame_count == 0)
         {
-            // Odd samples = right channel
-            if (m_right_samples.size() >= MAX_QUEUE_SIZE)
-            {
-                m_right_samples.pop(); // remove the oldest sample
-            }
-            m_right_samples.push(samples[i]);
+            vTaskDelay(1);
         }
     }
-    return true;
-}
\ No newline at end of file
+    m_left_samples.read(left, frame_count);
+    m_right_samples.read(right, frame_count);
+    int16_t *frames = reinterpret_cast<int16_t *>(samples);
+    for (size_t i = 0; i < frame_count; i++)
+    {
+        frames[2 * i] = left[i];
+        frames[2 * i + 1] = right[i];
+    }
+    byte_count = frame_count * 2 * sizeof(int16_t);
+}
+
+/**
+ * @brief Number of input samples lost, because the ring of the channel was full
+ */
+uint32_t I2SAudio::getSourceOverruns(AudioChannel channel)
+{
+    SampleRing *ring = sourceRing(channel);
+    return ring ? ring->overruns() : 0;
+}
@@ -3,7 +3,7 @@
 #include "I2SOutput.h"
 #include "I2SInput.h"
 #include "driver/i2s.h"
-#include <queue>
+#include "SpscRing.h"
 
 using namespace std;
 
@@ -23,34 +23,37 @@ struct BufferSyncMessage
 
 class I2SAudio
 {
+public:
+    enum class AudioChannel
+    {
+        LEFT, RIGHT, BOTH
+    };
+
 private:
     const i2s_port_t m_i2sPort;
     i2s_config_t m_i2sConfig;
     i2s_pin_config_t m_i2s_pin_config;
     const uint32_t m_sampleRate;
-    queue<int16_t> m_left_samples;
-    queue<int16_t> m_right_samples;
+    // Filled by the I2S reader task, emptied by getSourceSamples()
+    SampleRing m_left_samples;
+    SampleRing m_right_samples;
 
     I2SOutput *m_output = nullptr;
     xQueueHandle m_sample_sink = nullptr;
     
     I2SInput *m_input = nullptr;
-    xQueueHandle m_sample_source = nullptr;
-    bool fillSampleQueue();
+    SampleRing *sourceRing(AudioChannel channel);
 
 public:
-    enum class AudioChannel
-    {
-        LEFT, RIGHT, BOTH
-    };
     I2SAudio(const uint32_t sampleRate, int pin_BCK, int pin_WS, int pin_DOUT, int pin_DIN);
     ~I2SAudio();
     void init();
     void start_output(size_t maxMessages);
-    void start_input(size_t maxMessages);
+    void start_input();
     bool addSinkSamples(int16_t samples[], int count, AudioChannel channel);
     bool addRawSinkSamples(uint8_t samples[], int count);
     bool getSourceSamples(int16_t left_samples[], size_t &sample_count_per_channel, AudioChannel channel);
     void getRawSourceSamples(uint8_t samples[], size_t& count);
+    uint32_t getSourceOverruns(AudioChannel channel);
     void stop();
 };
\ No newline at end of file
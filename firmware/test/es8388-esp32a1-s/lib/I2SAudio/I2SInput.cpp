@@ -20,15 +20,27 @@ void i2sReaderTask(void *param)
         {
             BufferSyncMessage message;
             ESP_ERROR_CHECK(i2s_read(sampler->m_i2sPort, message.data, sizeof(message.data), &message.size, portMAX_DELAY));
-            xQueueSend(sampler->m_sample_source, &message, portMAX_DELAY);
+            // Even samples = left channel, odd samples = right channel
+            const int16_t *samples = reinterpret_cast<const int16_t *>(message.data);
+            size_t frame_count = message.size / (2 * sizeof(int16_t));
+            int16_t left[SAMPLE_BUFFER_SIZE / 4], right[SAMPLE_BUFFER_SIZE / 4];
+            for (size_t i = 0; i < frame_count; i++)
+            {
+                left[i] = samples[2 * i];
+                right[i] = samples[2 * i + 1];
+            }
+            // Never blocks: when the consumer falls behind, the samples are counted as overruns
+            sampler->m_left_samples->write(left, frame_count);
+            sampler->m_right_samples->write(right, frame_count);
         }
         taskYIELD();
     }
 }
 
-void I2SInput::start(xQueueHandle sample_source)
+void I2SInput::start(SampleRing *left_samples, SampleRing *right_samples)
 {
-    m_sample_source = sample_source;
+    m_left_samples = left_samples;
+    m_right_samples = right_samples;
     if (m_i2s_readerTaskHandle == NULL)
     {
         xTaskCreate(i2sReaderTask, "i2s Reader Task", 4096, this, 1, &m_i2s_readerTaskHandle);
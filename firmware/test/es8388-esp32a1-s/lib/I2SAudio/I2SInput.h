@@ -2,6 +2,11 @@
 
 #include <Arduino.h>
 #include "driver/i2s.h"
+#include "SpscRing.h"
+
+//! About 0.68s of samples per channel at the 48kHz of the codec (4s at 8kHz), to ride out the decoder being busy.
+//! Each ring takes 64KiB, I2SAudio holds two and lives on the heap.
+typedef SpscRing<int16_t, 32768> SampleRing;
 
 class I2SInput
 {
@@ -10,12 +15,13 @@ private:
     i2s_port_t m_i2sPort;
     // I2S reader task
     TaskHandle_t m_i2s_readerTaskHandle = NULL;
-    // src of samples for us to play
-    xQueueHandle m_sample_source;
+    // destination of the deinterleaved samples
+    SampleRing *m_left_samples = nullptr;
+    SampleRing *m_right_samples = nullptr;
 
 public:
     I2SInput(i2s_port_t i2sPort, i2s_pin_config_t *pin_config) : m_i2sPort(i2sPort){};
-    void start(xQueueHandle sample_source);
+    void start(SampleRing *left_samples, SampleRing *right_samples);
     void stop();
     friend void i2sReaderTask(void *param);
 };
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Wait-free ring buffer for one producer and one consumer
+ *
+ * @tparam T trivially copyable element type, e.g. int16_t samples
+ * @tparam CAPACITY number of elements, must be a power of two
+ * @note The producer and the consumer may run on different cores or tasks without any lock.  Each side only
+ *      writes its own index, which lives on a cache line of its own.  When the ring is full, write() keeps the
+ *      samples already in the ring, stores as many new ones as fit and counts the others as overruns.
+ *      Doesn't depend on Arduino or FreeRTOS, so it can be tested on Linux with std::thread.
+ */
+template <typename T, size_t CAPACITY>
+class SpscRing
+{
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+    static const size_t MASK = CAPACITY - 1;
+
+    // Written by the producer only
+    alignas(64) std::atomic<size_t> m_head{0};
+    std::atomic<uint32_t> m_overruns{0};
+    // Written by the consumer only
+    alignas(64) std::atomic<size_t> m_tail{0};
+    alignas(64) T m_buffer[CAPACITY];
+
+public:
+    /**
+     * @brief Producer side: append up to count elements
+     *
+     * @param data Pointer to the elements
+     * @param count Number of elements
+     * @return number of elements written, the rest is counted as overrun
+     */
+    size_t write(const T *data, size_t count)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t tail = m_tail.load(std::memory_order_acquire);
+        size_t n = CAPACITY - (head - tail);
+        if (n > count)
+        {
+            n = count;
+        }
+        size_t first = CAPACITY - (head & MASK);
+        if (first > n)
+        {
+            first = n;
+        }
+        memcpy(m_buffer + (head & MASK), data, first * sizeof(T));
+        memcpy(m_buffer, data + first, (n - first) * sizeof(T));
+        m_head.store(head + n, std::memory_order_release);
+        if (n < count)
+        {
+            m_overruns.fetch_add(count - n, std::memory_order_relaxed);
+        }
+        return n;
+    }
+
+    /**
+     * @brief Consumer side: take up to count elements
+     *
+     * @param data Pointer to the array receiving the elements
+     * @param count Maximum number of elements
+     * @return number of elements read, 0 if the ring is empty
+     */
+    size_t read(T *data, size_t count)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t head = m_head.load(std::memory_order_acquire);
+        size_t n = head - tail;
+        if (n > count)
+        {
+            n = count;
+        }
+        size_t first = CAPACITY - (tail & MASK);
+        if (first > n)
+        {
+            first = n;
+        }
+        memcpy(data, m_buffer + (tail & MASK), first * sizeof(T));
+        memcpy(data + first, m_buffer, (n - first) * sizeof(T));
+        m_tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    //! Number of elements ready to be read
+    size_t available() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    //! Number of elements that can be written without overrun
+    size_t space() const
+    {
+        return CAPACITY - available();
+    }
+
+    //! Number of elements that could not be written because the ring was full
+    uint32_t overruns() const
+    {
+        return m_overruns.load(std::memory_order_relaxed);
+    }
+
+    static constexpr size_t capacity()
+    {
+        return CAPACITY;
+    }
+};
@@ -56,7 +56,7 @@ void setup()
 	i2sAudio = new I2SAudio(8000, 27, 25, 26, 35);
 	i2sAudio->init();
 	i2sAudio->start_output(16);
-	i2sAudio->start_input(16);
+	i2sAudio->start_input();
 
 	delaytimer.start(1000, AsyncDelay::MILLIS);
 	ESP_LOGI(TAG, "Setup complete");